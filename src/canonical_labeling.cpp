@@ -0,0 +1,250 @@
+#include "canonical_labeling.h"
+
+// Mixes the bits of the given value. Used to compute the refinement values and the hashes.
+uint64 mix_bits64(uint64 x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Compares two sorted edge arrays of the given length lexicographically.
+// Returns a negative number if a < b, 0 if a == b, and a positive number if a > b.
+int compare_edges(uint8 edge_count, const Edge a[], const Edge b[]) {
+  for (int i = 0; i < edge_count; i++) {
+    if (a[i].vertex_set != b[i].vertex_set) return a[i].vertex_set < b[i].vertex_set ? -1 : 1;
+    if (a[i].head_vertex != b[i].head_vertex) return a[i].head_vertex < b[i].head_vertex ? -1 : 1;
+  }
+  return 0;
+}
+
+CanonicalLabeling::CanonicalLabeling(int n_, uint8 edge_count_, const Edge edges_[],
+                                     const uint8 cell_order[], uint16 cell_starts)
+    : stats_leaves(0),
+      stats_automorphisms(0),
+      n(n_),
+      edge_count(edge_count_),
+      edges(edges_),
+      first_path_length(0),
+      has_leaf(false) {
+  assert((cell_starts & 1) != 0);
+  std::copy(cell_order, cell_order + n, initial.order);
+  initial.starts = cell_starts;
+  for (int v = 0; v < n; v++) {
+    incident_count[v] = 0;
+  }
+  for (int i = 0; i < edge_count; i++) {
+    for (uint32 m = edges[i].vertex_set; m != 0; m &= m - 1) {
+      int v = __builtin_ctz(m);
+      incident[v][incident_count[v]++] = i;
+    }
+  }
+}
+
+void CanonicalLabeling::run() {
+  const uint16 discrete = (1 << n) - 1;
+  if (initial.starts == discrete) {
+    // Shortcut: the initial partition already determines the labeling.
+    for (int i = 0; i < n; i++) {
+      labels[initial.order[i]] = i;
+    }
+    return;
+  }
+  search(initial, 0);
+}
+
+void CanonicalLabeling::refine(Partition& p) const {
+  const uint16 discrete = (1 << n) - 1;
+  // The cell of each vertex, identified by the position where the cell starts.
+  uint8 cell[MAX_VERTICES];
+  // The refinement value of each vertex.
+  uint64 value[MAX_VERTICES];
+
+  while (p.starts != discrete) {
+    int start = 0;
+    for (int i = 0; i < n; i++) {
+      if ((p.starts & (1 << i)) != 0) start = i;
+      cell[p.order[i]] = start;
+    }
+
+    uint16 new_starts = p.starts;
+    for (int s = 0; s < n;) {
+      int e = s + 1;
+      while (e < n && (p.starts & (1 << e)) == 0) e++;
+      if (e - s > 1) {
+        // Compute the values of the vertices in this cell. The value of vertex v combines,
+        // for each edge through v, whether v is the head, the tail, or the edge is undirected,
+        // and the cells of the other vertices in the edge (and whether they are the head).
+        for (int i = s; i < e; i++) {
+          int v = p.order[i];
+          uint64 sum = 0;
+          for (int j = 0; j < incident_count[v]; j++) {
+            const Edge& edge = edges[incident[v][j]];
+            uint64 others = 0;
+            for (uint32 m = edge.vertex_set & ~(1 << v); m != 0; m &= m - 1) {
+              int u = __builtin_ctz(m);
+              others += mix_bits64(cell[u] * 2 + (u == edge.head_vertex ? 1 : 0) + 1);
+            }
+            int role = edge.head_vertex == UNDIRECTED ? 0 : (edge.head_vertex == v ? 1 : 2);
+            sum += mix_bits64(others * 3 + role);
+          }
+          value[v] = sum;
+        }
+        // Sort the cell by the values, then split it where the value changes.
+        std::sort(p.order + s, p.order + e, [&value](uint8 a, uint8 b) {
+          return value[a] < value[b];
+        });
+        for (int i = s + 1; i < e; i++) {
+          if (value[p.order[i]] != value[p.order[i - 1]]) new_starts |= 1 << i;
+        }
+      }
+      s = e;
+    }
+    if (new_starts == p.starts) break;
+    p.starts = new_starts;
+  }
+}
+
+int CanonicalLabeling::search(Partition p, int depth) {
+  refine(p);
+  if (p.starts == (1 << n) - 1) {
+    return process_leaf(p, depth);
+  }
+
+  // Find the first non-singleton cell [s, e), which is the target cell to individualize.
+  int s = 0;
+  int e = 1;
+  while (true) {
+    while (e < n && (p.starts & (1 << e)) == 0) e++;
+    if (e - s > 1) break;
+    s = e++;
+  }
+
+  // The orbits of the automorphisms that fix every vertex on the path, as a union-find forest.
+  uint8 orbit[MAX_VERTICES];
+  for (int v = 0; v < n; v++) {
+    orbit[v] = v;
+  }
+  auto find = [&orbit](int v) {
+    while (orbit[v] != v) v = orbit[v];
+    return v;
+  };
+  size_t orbit_automorphisms = 0;
+
+  // Bitmask of the vertices in the target cell that have been individualized.
+  uint16 explored = 0;
+  for (int i = s; i < e; i++) {
+    int w = p.order[i];
+
+    // Update the orbits with the automorphisms found since the last child.
+    for (; orbit_automorphisms < automorphisms.size(); orbit_automorphisms++) {
+      const auto& a = automorphisms[orbit_automorphisms];
+      bool fixes_path = true;
+      for (int d = 0; d < depth && fixes_path; d++) {
+        fixes_path = a[path[d]] == path[d];
+      }
+      if (!fixes_path) continue;
+      for (int v = 0; v < n; v++) {
+        int x = find(v);
+        int y = find(a[v]);
+        if (x != y) orbit[std::max(x, y)] = std::min(x, y);
+      }
+    }
+    // Skip w if an automorphism maps an explored vertex to w.
+    bool equivalent = false;
+    for (uint32 m = explored; m != 0 && !equivalent; m &= m - 1) {
+      equivalent = find(__builtin_ctz(m)) == find(w);
+    }
+    if (equivalent) continue;
+
+    // Individualize w by moving it to the front of the target cell as a singleton cell.
+    Partition child = p;
+    child.order[i] = child.order[s];
+    child.order[s] = w;
+    child.starts |= 1 << (s + 1);
+    path[depth] = w;
+    int target = search(child, depth + 1);
+    explored |= 1 << w;
+    if (target < depth) return target;
+  }
+  return depth;
+}
+
+int CanonicalLabeling::process_leaf(const Partition& p, int depth) {
+  ++stats_leaves;
+  int labeling[MAX_VERTICES];
+  for (int i = 0; i < n; i++) {
+    labeling[p.order[i]] = i;
+  }
+  Edge relabeled[MAX_EDGES];
+  relabel_edges(labeling, relabeled);
+
+  if (!has_leaf) {
+    has_leaf = true;
+    std::copy(labeling, labeling + n, first_labels);
+    std::copy(labeling, labeling + n, labels);
+    std::copy(relabeled, relabeled + edge_count, first_edges);
+    std::copy(relabeled, relabeled + edge_count, best_edges);
+    std::copy(path, path + depth, first_path);
+    first_path_length = depth;
+    return depth;
+  }
+
+  if (compare_edges(edge_count, relabeled, first_edges) == 0) {
+    add_automorphism(labeling, first_labels);
+    // The subtree where this path diverges from the first path is equivalent to the subtree
+    // containing the first leaf, so go back to the node where the paths diverge.
+    int d = 0;
+    while (d < depth && d < first_path_length && path[d] == first_path[d]) d++;
+    return d;
+  }
+
+  int result = compare_edges(edge_count, relabeled, best_edges);
+  if (result < 0) {
+    std::copy(labeling, labeling + n, labels);
+    std::copy(relabeled, relabeled + edge_count, best_edges);
+  } else if (result == 0) {
+    add_automorphism(labeling, labels);
+  }
+  return depth;
+}
+
+void CanonicalLabeling::add_automorphism(const int from[], const int to[]) {
+  int inverse[MAX_VERTICES];
+  for (int v = 0; v < n; v++) {
+    inverse[to[v]] = v;
+  }
+  std::array<uint8, MAX_VERTICES> a;
+  bool is_identity = true;
+  for (int v = 0; v < n; v++) {
+    a[v] = inverse[from[v]];
+    is_identity = is_identity && a[v] == v;
+  }
+  if (is_identity) return;
+  ++stats_automorphisms;
+  automorphisms.push_back(a);
+}
+
+void CanonicalLabeling::relabel_edges(const int labeling[], Edge result[]) const {
+  // Same as Graph::finalize_edges(): scatter the relabeled edges into a bitmap indexed by the
+  // edge rank, then list them by increasing rank, which is the sorted order.
+  const VertexSetPermutation permutation(labeling, n);
+  uint64 bits[2]{0, 0};
+  uint8 heads[MAX_EDGES];
+  for (int i = 0; i < edge_count; i++) {
+    int rank = Graph::EDGE_RANKS[permutation.apply(edges[i].vertex_set)];
+    uint8 head = edges[i].head_vertex;
+    bits[rank >> 6] |= static_cast<uint64>(1) << (rank & 63);
+    heads[rank] = head == UNDIRECTED ? UNDIRECTED : labeling[head];
+  }
+  const uint16* masks = Graph::VERTEX_MASKS[Graph::K].masks;
+  int i = 0;
+  for (int word = 0; word < 2; word++) {
+    for (uint64 m = bits[word]; m != 0; m &= m - 1) {
+      int rank = (word << 6) + __builtin_ctzll(m);
+      result[i++] = Edge(masks[rank], heads[rank]);
+    }
+  }
+}
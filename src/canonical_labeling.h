@@ -0,0 +1,107 @@
+#pragma once
+#include "graph.h"
+
+// Mixes the bits of the given value, so that sums of mixed values make good hashes of multisets.
+uint64 mix_bits64(uint64 x);
+
+// Computes a canonical labeling of a k-PDG, using the individualization-refinement method
+// (the same idea as nauty, specialized to k-PDG edges with heads).
+//
+// A canonical labeling maps the vertices to 0..n-1 such that two graphs get exactly the same
+// relabeled edge set if and only if they are isomorphic. This allows isomorphism checks to be
+// reduced to identity checks of the canonicalized graphs.
+//
+// How it works:
+// (1) We start from an ordered partition of the vertices into cells, given by the caller.
+//     Graph::canonicalize() uses the vertex degrees, ordered by decreasing degrees.
+// (2) Refinement: for each vertex we compute a value from its incident edges that only depends
+//     on the cells (not the labels) of the vertices in these edges. Each cell is split according
+//     to these values, and this is repeated until no cell can be split any more.
+// (3) If all cells are singletons, the order of the cells gives a labeling (a leaf of the search
+//     tree). Otherwise, we pick the first non-singleton cell, and for each vertex in the cell,
+//     individualize it (split it into its own cell in front of the rest of the cell), and
+//     continue with (2). The canonical labeling is the leaf with the lexicographically smallest
+//     relabeled edge list.
+// Since every step only depends on the graph structure but not the labels, isomorphic graphs
+// produce the same set of relabeled edge lists at the leaves, thus the same smallest one.
+//
+// Two leaves producing the same relabeled edge list give an automorphism of the graph. The
+// automorphisms are used to prune the search tree: at a tree node, two children that are mapped
+// to each other by an automorphism fixing the path to the node have the same set of leaves, so
+// only one of them needs to be explored. And if a leaf is the same as the first leaf, the entire
+// subtree where its path diverges from the first path is equivalent to a subtree that is already
+// explored, so we can return to that node directly.
+class CanonicalLabeling {
+ public:
+  // Initializes the labeling search for a graph with n vertices and the given edges. Each edge
+  // must have exactly Graph::K vertices, as the edges are ordered by their ranks (EDGE_RANKS).
+  // `cell_order` lists all n vertices ordered by the initial partition, and `cell_starts` has
+  // bit i set iff a cell starts at position i in `cell_order`. Bit 0 must be set.
+  // The initial partition must be invariant under isomorphisms, e.g. from the vertex degrees.
+  CanonicalLabeling(int n, uint8 edge_count, const Edge edges[], const uint8 cell_order[],
+                    uint16 cell_starts);
+
+  // Runs the search. After that, `labels` holds the canonical labeling: vertex v is relabeled
+  // to labels[v]. The relabeled vertices keep the order of the initial partition, i.e. if u is
+  // in an earlier cell than v in the initial partition, then labels[u] < labels[v].
+  void run();
+
+  // The result of run().
+  int labels[MAX_VERTICES];
+
+  // Some statistics of the search, used to monitor the performance.
+  uint32 stats_leaves;         // How many leaves of the search tree are visited.
+  uint32 stats_automorphisms;  // How many automorphisms are found.
+
+ private:
+  // An ordered partition of the vertices. Position i in `order` is the start of a cell iff
+  // bit i in `starts` is set.
+  struct Partition {
+    uint8 order[MAX_VERTICES];
+    uint16 starts;
+  };
+
+  const int n;
+  const uint8 edge_count;
+  const Edge* const edges;
+  Partition initial;
+
+  // The edges incident to each vertex, as indices into `edges`.
+  uint8 incident_count[MAX_VERTICES];
+  uint8 incident[MAX_VERTICES][MAX_EDGES];
+
+  // The vertices individualized along the current path in the search tree.
+  uint8 path[MAX_VERTICES];
+  // The path to the first leaf.
+  uint8 first_path[MAX_VERTICES];
+  int first_path_length;
+
+  // The labeling and the relabeled (sorted) edges of the first leaf and the best leaf so far.
+  // `has_leaf` is false until the first leaf is found.
+  bool has_leaf;
+  int first_labels[MAX_VERTICES];
+  Edge first_edges[MAX_EDGES];
+  Edge best_edges[MAX_EDGES];
+
+  // The automorphisms found so far. automorphisms[i][v] is the image of v.
+  std::vector<std::array<uint8, MAX_VERTICES>> automorphisms;
+
+  // Refines the partition until no cell can be split any more.
+  void refine(Partition& p) const;
+
+  // Searches the subtree rooted at the node with the given partition (before refinement), where
+  // `depth` vertices are individualized. Returns the depth of the tree node where the search
+  // should continue: any ancestor with a larger depth should return immediately.
+  int search(Partition p, int depth);
+
+  // Processes a leaf of the search tree with a discrete partition. Returns the depth where the
+  // search should continue, see search().
+  int process_leaf(const Partition& p, int depth);
+
+  // Given two leaf labelings that produce the same relabeled edges, records the automorphism
+  // that maps each vertex v to the vertex u with to[u] == from[v].
+  void add_automorphism(const int from[], const int to[]);
+
+  // Computes the relabeled and sorted edges under the given labeling.
+  void relabel_edges(const int labeling[], Edge result[]) const;
+};
@@ -6,31 +6,36 @@ constexpr int PRINT_EVERY_N_SECONDS = 100;
 
 Fraction Counters::min_ratio = Fraction::infinity();
 Graph Counters::min_ratio_graph{};
-uint64 Counters::compute_vertex_signatures = 0;
+std::atomic<uint64> Counters::compute_vertex_signatures = 0;
+std::atomic<uint64> Counters::compute_vertex_signatures_avoided = 0;
 std::atomic<uint64> Counters::graph_copies = 0;
 std::atomic<uint64> Counters::graph_contains_Tk_tests = 0;
-uint64 Counters::growth_processed_graphs_in_current_step = 0;
-uint64 Counters::graph_accumulated_canonicals = 0;
-uint64 Counters::graph_canonicalize_ops = 0;
-uint64 Counters::graph_isomorphic_tests = 0;
-uint64 Counters::graph_isomorphic_true = 0;
-uint64 Counters::graph_isomorphic_expensive = 0;
-uint64 Counters::graph_isomorphic_hash_no = 0;
-uint64 Counters::graph_isomorphic_codeg_diff = 0;
-uint64 Counters::graph_identical_tests = 0;
-uint64 Counters::graph_permute_ops = 0;
-uint64 Counters::graph_permute_canonical_ops = 0;
+std::atomic<uint64> Counters::growth_processed_graphs_in_current_step = 0;
+std::atomic<uint64> Counters::graph_accumulated_canonicals = 0;
+std::atomic<uint64> Counters::graph_canonicalize_ops = 0;
+std::atomic<uint64> Counters::graph_isomorphic_tests = 0;
+std::atomic<uint64> Counters::graph_isomorphic_true = 0;
+std::atomic<uint64> Counters::graph_isomorphic_hash_no = 0;
+std::atomic<uint64> Counters::graph_isomorphic_codeg_diff = 0;
+std::atomic<uint64> Counters::graph_identical_tests = 0;
+std::atomic<uint64> Counters::graph_permute_ops = 0;
+std::atomic<uint64> Counters::graph_canonical_leaves = 0;
+std::atomic<uint64> Counters::graph_canonical_automorphisms = 0;
 std::chrono::time_point<std::chrono::steady_clock> Counters::start_time;
 std::chrono::time_point<std::chrono::steady_clock> Counters::last_print_time;
 uint64 Counters::growth_vertex_count = 0;
 uint64 Counters::growth_total_graphs_in_current_step = 0;
-uint64 Counters::growth_accumulated_canonicals_in_current_step = 0;
+std::atomic<uint64> Counters::growth_accumulated_canonicals_in_current_step = 0;
 uint64 Counters::growth_num_base_graphs_in_final_step = 0;
-uint64 Counters::edgegen_tk_skip = 0;
-uint64 Counters::edgegen_tk_skip_bits = 0;
-uint64 Counters::edgegen_theta_edges_skip = 0;
-uint64 Counters::edgegen_theta_directed_edges_skip = 0;
-uint64 Counters::edgegen_edge_sets = 0;
+uint64 Counters::final_split_tasks = 0;
+std::atomic<uint64> Counters::edgegen_tk_skip = 0;
+std::atomic<uint64> Counters::edgegen_tk_skip_bits = 0;
+std::atomic<uint64> Counters::edgegen_tk_conflict_skip = 0;
+std::atomic<uint64> Counters::edgegen_tk_conflict_skip_bits = 0;
+std::atomic<uint64> Counters::edgegen_theta_edges_skip = 0;
+std::atomic<uint64> Counters::edgegen_theta_directed_edges_skip = 0;
+std::atomic<uint64> Counters::edgegen_symmetry_skip = 0;
+std::atomic<uint64> Counters::edgegen_edge_sets = 0;
 uint64 Counters::ratio_graph_count = 0;
 bool Counters::in_final_step = false;
 
@@ -103,12 +108,22 @@ void Counters::observe_ratio(const Graph& g, Fraction ratio, uint64 graphs_proce
   print_at_time_interval();
 }
 
-void Counters::observe_edgegen_stats(uint64 tk_skip, uint64 tk_skip_bits, uint64 theta_edges_skip,
-                                     uint64 theta_directed_edges_skip, uint64 edge_sets) {
+void Counters::observe_graphs_processed(uint64 graphs_processed) {
+  graph_accumulated_canonicals += graphs_processed;
+  growth_accumulated_canonicals_in_current_step += graphs_processed;
+}
+
+void Counters::observe_edgegen_stats(uint64 tk_skip, uint64 tk_skip_bits, uint64 tk_conflict_skip,
+                                     uint64 tk_conflict_skip_bits, uint64 theta_edges_skip,
+                                     uint64 theta_directed_edges_skip, uint64 symmetry_skip,
+                                     uint64 edge_sets) {
   edgegen_tk_skip += tk_skip;
   edgegen_tk_skip_bits += tk_skip_bits;
+  edgegen_tk_conflict_skip += tk_conflict_skip;
+  edgegen_tk_conflict_skip_bits += tk_conflict_skip_bits;
   edgegen_theta_edges_skip += theta_edges_skip;
   edgegen_theta_directed_edges_skip += theta_directed_edges_skip;
+  edgegen_symmetry_skip += symmetry_skip;
   edgegen_edge_sets += edge_sets;
 }
 
@@ -124,6 +139,7 @@ void Counters::enter_final_step(uint64 num_base_graphs) {
   min_ratio = Fraction::infinity();
   growth_num_base_graphs_in_final_step = num_base_graphs;
   growth_processed_graphs_in_current_step = 0;
+  final_split_tasks = 0;
 }
 
 void Counters::initialize_ratio_graph_search(Fraction ratio_threshold) {
@@ -190,25 +206,29 @@ void Counters::print_counters_to_stream(std::ostream& os) {
 
   if (in_final_step) {
     os << "    Base graphs processed / total = " << fmt(growth_processed_graphs_in_current_step)
-       << " / " << fmt(growth_num_base_graphs_in_final_step) << ". Ops (copies, T_k, free)= ("
-       << fmt(graph_copies) << ", " << fmt(graph_contains_Tk_tests) << ", "
-       << fmt(growth_accumulated_canonicals_in_current_step)
-       << ")\n    EdgeGen stats (tk-skip, bits, theta_edge_skip, theta_dir_skip, sets)= ("
+       << " / " << fmt(growth_num_base_graphs_in_final_step)
+       << ", split tasks = " << fmt(final_split_tasks)
+       << ". Ops (copies, T_k, free, vertex sig avoided)= (" << fmt(graph_copies) << ", "
+       << fmt(graph_contains_Tk_tests) << ", " << fmt(growth_accumulated_canonicals_in_current_step)
+       << ", " << fmt(compute_vertex_signatures_avoided)
+       << ")\n    EdgeGen stats (tk-skip, bits, conflict-skip, bits, theta_edge_skip, "
+          "theta_dir_skip, symmetry_skip, sets)= ("
        << fmt(edgegen_tk_skip) << ", " << fmt(edgegen_tk_skip_bits) << ", "
+       << fmt(edgegen_tk_conflict_skip) << ", " << fmt(edgegen_tk_conflict_skip_bits) << ", "
        << fmt(edgegen_theta_edges_skip) << ", " << fmt(edgegen_theta_directed_edges_skip) << ", "
-       << fmt(edgegen_edge_sets) << ")\n";
+       << fmt(edgegen_symmetry_skip) << ", " << fmt(edgegen_edge_sets) << ")\n";
   } else {
     os << "    Accumulated canonicals\t= " << fmt(graph_accumulated_canonicals)
-       << "\n    Ops (vertex sig, copies, canonicalize, permute, T_k)= ("
-       << fmt(compute_vertex_signatures) << ", " << fmt(graph_copies) << ", "
-       << fmt(graph_canonicalize_ops) << ", " << fmt(graph_permute_canonical_ops) << ", "
+       << "\n    Ops (vertex sig, vertex sig avoided, copies, canonicalize, T_k)= ("
+       << fmt(compute_vertex_signatures) << ", " << fmt(compute_vertex_signatures_avoided) << ", "
+       << fmt(graph_copies) << ", " << fmt(graph_canonicalize_ops) << ", "
        << fmt(graph_contains_Tk_tests) << ")"
-       << "\n    Isomorphic tests (total, true, expensive, false w/ =hash, identical, "
-          "codeg_diff)= "
-       << "\n                     (" << fmt(graph_isomorphic_tests) << ", "
-       << fmt(graph_isomorphic_true) << ", " << fmt(graph_isomorphic_expensive) << ", "
-       << fmt(graph_isomorphic_hash_no) << ", " << fmt(graph_identical_tests) << ", "
-       << fmt(graph_isomorphic_codeg_diff) << ")"
+       << "\n    Canonical labeling (codeg_diff, leaves, automorphisms)= ("
+       << fmt(graph_isomorphic_codeg_diff) << ", " << fmt(graph_canonical_leaves) << ", "
+       << fmt(graph_canonical_automorphisms) << ")"
+       << "\n    Isomorphic tests (total, true, false w/ =hash, identical)= ("
+       << fmt(graph_isomorphic_tests) << ", " << fmt(graph_isomorphic_true) << ", "
+       << fmt(graph_isomorphic_hash_no) << ", " << fmt(graph_identical_tests) << ")"
        << "\n    Growth stats(vertices, total in step, processed in step, accumulated in step)= ("
        << fmt(growth_vertex_count) << ", " << fmt(growth_total_graphs_in_current_step) << ", "
        << fmt(growth_processed_graphs_in_current_step) << ", "
@@ -19,34 +19,50 @@ class Counters {
   // True if we are already in the final step to enumerate graphs.
   static bool in_final_step;
 
-  static uint64 compute_vertex_signatures;
+  static std::atomic<uint64> compute_vertex_signatures;
+  // Number of full vertex signature recomputations avoided, because the vertex degrees are
+  // maintained incrementally as edges are added.
+  static std::atomic<uint64> compute_vertex_signatures_avoided;
   static std::atomic<uint64> graph_copies;
   static std::atomic<uint64> graph_contains_Tk_tests;
-  static uint64 growth_processed_graphs_in_current_step;
-  static uint64 graph_accumulated_canonicals;
-  static uint64 graph_canonicalize_ops;
-  static uint64 graph_isomorphic_tests;
+  static std::atomic<uint64> growth_processed_graphs_in_current_step;
+  static std::atomic<uint64> graph_accumulated_canonicals;
+  static std::atomic<uint64> graph_canonicalize_ops;
+  static std::atomic<uint64> graph_isomorphic_tests;
   // Number of isomorphic tests that returned true.
-  static uint64 graph_isomorphic_true;
-  // Number of isomorphic tests that have to use vertex permutations.
-  static uint64 graph_isomorphic_expensive;
+  static std::atomic<uint64> graph_isomorphic_true;
   // Number of isomorphic tests that result in no, but had identical hash
-  static uint64 graph_isomorphic_hash_no;
-  // Among the cases where hash code match but the graphs are not isomorphic, the number of cases
-  // where the codegree info are different.
-  static uint64 graph_isomorphic_codeg_diff;
-  static uint64 graph_identical_tests;
-  static uint64 graph_permute_ops;
-  static uint64 graph_permute_canonical_ops;
+  static std::atomic<uint64> graph_isomorphic_hash_no;
+  // Number of canonicalized graphs where the codegree info tells apart vertices with the same
+  // degrees. The codegree info is also in the graph hash, so these are the graphs where the
+  // codegree info helps avoid hash collisions, and reduces the canonical labeling search.
+  static std::atomic<uint64> graph_isomorphic_codeg_diff;
+  static std::atomic<uint64> graph_identical_tests;
+  static std::atomic<uint64> graph_permute_ops;
+  // Number of leaves visited, and automorphisms found, in the canonical labeling searches.
+  static std::atomic<uint64> graph_canonical_leaves;
+  static std::atomic<uint64> graph_canonical_automorphisms;
   static uint64 growth_vertex_count;
   static uint64 growth_total_graphs_in_current_step;
-  static uint64 growth_accumulated_canonicals_in_current_step;
+  static std::atomic<uint64> growth_accumulated_canonicals_in_current_step;
   static uint64 growth_num_base_graphs_in_final_step;
-  static uint64 edgegen_tk_skip;           // How many notify_contain_tk_skip().
-  static uint64 edgegen_tk_skip_bits;      // How many bits did notify_contain_tk_skip() skip.
-  static uint64 edgegen_theta_edges_skip;  // How many skips due to min_theta opt, not enough edges.
-  static uint64 edgegen_theta_directed_edges_skip;  // How many skips min_theta opt, directed.
-  static uint64 edgegen_edge_sets;  // How many edge sets returned from this generator.
+  // Number of tasks split off from the base graphs in the final step, for the idle threads.
+  static uint64 final_split_tasks;
+  // The edge gen stats, which the worker threads add without a lock.
+  // How many notify_contain_tk_skip(), and how many bits did they skip.
+  static std::atomic<uint64> edgegen_tk_skip;
+  static std::atomic<uint64> edgegen_tk_skip_bits;
+  // How many skips beyond the lowest edge by conflicts, and how many bits did these skip beyond
+  // that.
+  static std::atomic<uint64> edgegen_tk_conflict_skip;
+  static std::atomic<uint64> edgegen_tk_conflict_skip_bits;
+  // How many skips due to min_theta opt, not enough edges, and not enough directed edges.
+  static std::atomic<uint64> edgegen_theta_edges_skip;
+  static std::atomic<uint64> edgegen_theta_directed_edges_skip;
+  // How many skips due to the base automorphisms.
+  static std::atomic<uint64> edgegen_symmetry_skip;
+  // How many edge sets returned from the generators.
+  static std::atomic<uint64> edgegen_edge_sets;
 
   // How many graphs found to be <= given ratio value, in ratio-graph search.
   static uint64 ratio_graph_count;
@@ -77,21 +93,27 @@ class Counters {
   static Fraction get_min_ratio() { return min_ratio; }
   static const Graph& get_min_ratio_graph() { return min_ratio_graph; }
   static uint64 get_ratio_graph_count() { return ratio_graph_count; }
+  static uint64 get_graph_isomorphic_codeg_diff() { return graph_isomorphic_codeg_diff; }
   static void increment_compute_vertex_signatures() { ++compute_vertex_signatures; }
+  static void increment_compute_vertex_signatures_avoided() { ++compute_vertex_signatures_avoided; }
   static void increment_graph_copies() { ++graph_copies; }
   static void increment_graph_canonicalize_ops() { ++graph_canonicalize_ops; }
   static void increment_graph_isomorphic_tests() { ++graph_isomorphic_tests; }
   static void increment_graph_isomorphic_true() { ++graph_isomorphic_true; }
-  static void increment_graph_isomorphic_expensive() { ++graph_isomorphic_expensive; }
   static void increment_graph_isomorphic_hash_no() { ++graph_isomorphic_hash_no; }
   static void increment_graph_isomorphic_codeg_diff() { ++graph_isomorphic_codeg_diff; }
   static void increment_graph_identical_tests() { ++graph_identical_tests; }
   static void increment_graph_permute_ops() { ++graph_permute_ops; }
-  static void increment_graph_permute_canonical_ops() { ++graph_permute_canonical_ops; }
+  static void observe_canonical_labeling(uint64 leaves, uint64 automorphisms) {
+    graph_canonical_leaves += leaves;
+    graph_canonical_automorphisms += automorphisms;
+  }
   static void increment_graph_contains_Tk_tests() { ++graph_contains_Tk_tests; }
   static void increment_growth_processed_graphs_in_current_step() {
     ++growth_processed_graphs_in_current_step;
   }
+  static uint64 get_final_split_tasks() { return final_split_tasks; }
+  static void observe_final_split_tasks(uint64 count) { final_split_tasks += count; }
   // Initialize the counters before starting the ratio-graph search.
   static void initialize_ratio_graph_search(Fraction ratio_threshold);
   // Notify that a graph matching the ratio value is found during ratio-graph search.
@@ -105,10 +127,15 @@ class Counters {
 
   // If the given graph's ratio value is less than min_ratio, assign it to min_ratio.
   static void observe_ratio(const Graph& g, Fraction ratio, uint64 graphs_processed = 1);
-
-  // Adds the edge gen stats to the counters.
-  static void observe_edgegen_stats(uint64 tk_skip, uint64 tk_skip_bits, uint64 theta_edges_skip,
-                                    uint64 theta_directed_edges_skip, uint64 edge_sets);
+  // Adds the number of graphs processed, without a ratio to observe. It only updates atomic
+  // counters, so it can be called without a lock.
+  static void observe_graphs_processed(uint64 graphs_processed);
+
+  // Adds the edge gen stats to the counters. It can be called without a lock.
+  static void observe_edgegen_stats(uint64 tk_skip, uint64 tk_skip_bits, uint64 tk_conflict_skip,
+                                    uint64 tk_conflict_skip_bits, uint64 theta_edges_skip,
+                                    uint64 theta_directed_edges_skip, uint64 symmetry_skip,
+                                    uint64 edge_sets);
 
   // Print status if sufficient time has elapsed since the last print.
   static void print_at_time_interval();
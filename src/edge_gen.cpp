@@ -31,22 +31,144 @@ EdgeCandidates::EdgeCandidates(int vertex_count) : n(vertex_count), edge_candida
   }
 }
 
+EdgeCandidates::EdgeCandidates(int vertex_count, const Graph& base, CandidateOrder order)
+    : EdgeCandidates(vertex_count) {
+  if (order == CandidateOrder::NATURAL) return;
+  // The degree of each candidate: the number of base edges containing its other K-1 vertices.
+  const uint16 new_vertex = 1 << (n - 1);
+  int degrees[MAX_EDGES];
+  for (int e = 0; e < edge_candidate_count; e++) {
+    const uint16 others = edge_candidates[e] & ~new_vertex;
+    degrees[e] = 0;
+    for (int rank = 0; rank < Graph::TOTAL_EDGES; rank++) {
+      const uint16 vertex_set = Graph::VERTEX_MASKS[Graph::K].masks[rank];
+      if ((vertex_set & others) == others && base.has_edge_rank(rank)) ++degrees[e];
+    }
+  }
+  std::vector<int> sorted(edge_candidate_count);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  std::stable_sort(sorted.begin(), sorted.end(), [&degrees, order](int a, int b) {
+    return order == CandidateOrder::HIGH_DEGREE ? degrees[a] > degrees[b] : degrees[a] < degrees[b];
+  });
+
+  const EdgeCandidates natural(*this);
+  for (int e = 0; e < edge_candidate_count; e++) {
+    edge_candidates[e] = natural.edge_candidates[sorted[e]];
+    std::copy(natural.edge_candidates_heads[sorted[e]],
+              natural.edge_candidates_heads[sorted[e]] + Graph::K + 2, edge_candidates_heads[e]);
+  }
+}
+
+CandidateSymmetry::CandidateSymmetry(const EdgeCandidates& edge_candidates, const Graph& base)
+    : candidate_count(edge_candidates.edge_candidate_count), automorphism_count(0) {
+  std::vector<std::array<uint8, MAX_VERTICES>> automorphisms;
+  base.compute_automorphisms(edge_candidates.n - 1, MAX_AUTOMORPHISMS, automorphisms);
+  automorphism_count = automorphisms.size();
+
+  // The candidate index of each vertex set.
+  std::vector<uint8> index(1 << edge_candidates.n, 0);
+  for (int i = 0; i < candidate_count; i++) {
+    index[edge_candidates.edge_candidates[i]] = i;
+  }
+  const int states = Graph::K + 2;
+  sources.resize(automorphism_count * candidate_count);
+  image_states.resize(sources.size() * states);
+  for (int a = 0; a < automorphism_count; a++) {
+    int p[MAX_VERTICES];
+    std::copy(automorphisms[a].begin(), automorphisms[a].end(), p);
+    const VertexSetPermutation permutation(p, edge_candidates.n);
+    for (int i = 0; i < candidate_count; i++) {
+      const int q = index[permutation.apply(edge_candidates.edge_candidates[i])];
+      const int j = a * candidate_count + q;
+      sources[j] = i;
+      // Absent and undirected are kept, and a head is mapped to the state of its image.
+      uint8* image = &image_states[j * states];
+      image[0] = 0;
+      image[1] = 1;
+      for (int s = 2; s < states; s++) {
+        const uint8 head = p[edge_candidates.edge_candidates_heads[i][s]];
+        int t = 2;
+        while (edge_candidates.edge_candidates_heads[q][t] != head) t++;
+        image[s] = t;
+      }
+    }
+  }
+}
+
+bool CandidateSymmetry::is_first(const uint8 state[], int& skip) const {
+  skip = -1;
+  for (int a = 0; a < automorphism_count; a++) {
+    // Compare the image with the state from the highest candidate. The result only depends on
+    // the candidates compared so far and their sources, the lowest of which is `low`.
+    int low = candidate_count;
+    for (int q = candidate_count - 1; q >= 0 && low > skip; q--) {
+      low = std::min(low, std::min(q, static_cast<int>(source(a, q))));
+      const uint8 image = image_state(a, q, state);
+      if (image != state[q]) {
+        if (image < state[q]) skip = std::max(skip, low);
+        break;
+      }
+    }
+  }
+  return skip < 0;
+}
+
+// The bound of theta_ratio, where the free edges are directed.
+class ThetaBound : public RatioBound {
+ public:
+  const RatioTable& get_ratio_table() const override { return Graph::THETA_RATIOS; }
+  bool is_directed_better() const override { return true; }
+  int min_rank(int undirected, int directed, int free_edges) const override {
+    return Graph::THETA_RATIOS.get_rank(undirected, directed + free_edges);
+  }
+};
+
+// The bound of zeta_ratio, where the free edges are undirected.
+class ZetaBound : public RatioBound {
+ public:
+  const RatioTable& get_ratio_table() const override { return Graph::ZETA_RATIOS; }
+  bool is_directed_better() const override { return false; }
+  int min_rank(int undirected, int directed, int free_edges) const override {
+    return Graph::ZETA_RATIOS.get_rank(undirected + free_edges, directed);
+  }
+};
+
+static const ThetaBound theta_bound;
+static const ZetaBound zeta_bound;
+const RatioBound& RatioBound::THETA = theta_bound;
+const RatioBound& RatioBound::ZETA = zeta_bound;
+
 EdgeGenerator::EdgeGenerator(const EdgeCandidates& edge_candidates, const Graph& base_graph)
     : candidates(edge_candidates),
       base(base_graph),
       stats_tk_skip(0),
       stats_tk_skip_bits(0),
+      stats_tk_conflict_skip(0),
+      stats_tk_conflict_skip_bits(0),
       stats_theta_edges_skip(0),
       stats_theta_directed_edges_skip(0),
-      stats_edge_sets(0) {
+      stats_symmetry_skip(0),
+      stats_edge_sets(0),
+      threshold_min_ratio(0, 1),
+      threshold_ratio_rank(0),
+      new_edge_threshold(0),
+      generated_graph(nullptr),
+      has_free_state(false),
+      has_tk_conflicts(false),
+      use_tk_conflict_skip(false),
+      free_count(edge_candidates.edge_candidate_count),
+      at_range_start(false),
+      symmetry(nullptr),
+      bound(&RatioBound::THETA) {
   for (uint8 i = 0; i < candidates.edge_candidate_count; i++) {
     enum_state[i] = 0;
   }
 }
 
 void EdgeGenerator::clear_stats() {
-  stats_tk_skip = stats_tk_skip_bits = stats_theta_edges_skip = stats_theta_directed_edges_skip =
-      stats_edge_sets = 0;
+  stats_tk_skip = stats_tk_skip_bits = stats_tk_conflict_skip = stats_tk_conflict_skip_bits =
+      stats_theta_edges_skip = stats_theta_directed_edges_skip = stats_symmetry_skip =
+          stats_edge_sets = 0;
 }
 
 // Generates the next edge set. Returns true enumeration should proceed,
@@ -54,56 +176,130 @@ void EdgeGenerator::clear_stats() {
 // calling this function, all its state will be reset.)
 // Returns false if all possibilities have already been enumerated.
 //
-// use_known_min_theta_opt = whether min_theta optimization should be used. If false,
+// use_known_min_ratio_opt = whether min ratio optimization should be used. If false,
 //    the rest of the paramters are all ignored.
-// known_min_theta = the currently know min_theta value.
+// known_min_ratio = the currently know min ratio value.
 //
-// The min_theta optimization: this should only be used in the final enumeration phase, not
+// The min ratio optimization: this should only be used in the final enumeration phase, not
 // in the growth phase before the final step.
 //
-// The idea is, if the graph is too sparse, then its theta is guaranteed to be larger than
-// the currently known min_theta value, in which case we don't care about this graph since
-// it won't give us a better min_theta value regardless whether the graph is T_k free.
-bool EdgeGenerator::next(Graph& copy, bool use_known_min_theta_opt, Fraction known_min_theta) {
-  if (use_known_min_theta_opt) {
-    // Assert that we are using min_theta optimization only in the final enumeration phase.
+// The idea is, if the graph is too sparse, then its ratio is guaranteed to be larger than
+// the currently known min ratio value, in which case we don't care about this graph since
+// it won't give us a better min ratio value regardless whether the graph is T_k free.
+bool EdgeGenerator::next(Graph& copy, bool use_known_min_ratio_opt, Fraction known_min_ratio) {
+  if (use_known_min_ratio_opt) {
+    // Assert that we are using min ratio optimization only in the final enumeration phase.
     assert(candidates.n == Graph::N);
-    assert(known_min_theta >= Fraction(1, 1));
+    assert(bound != nullptr);
+    assert(known_min_ratio >= Fraction(1, 1));
   }
 
   while (true) {
-    bool has_valid_candidate = false;
-    for (uint8 i = 0; i < candidates.edge_candidate_count; i++) {
-      ++enum_state[i];
-      if (enum_state[i] != Graph::K + 2) {
-        has_valid_candidate = true;
-        break;
+    if (at_range_start) {
+      at_range_start = false;
+    } else {
+      bool has_valid_candidate = false;
+      for (int i = 0; i < free_count; i++) {
+        ++enum_state[i];
+        if (enum_state[i] != Graph::K + 2) {
+          has_valid_candidate = true;
+          break;
+        }
+        enum_state[i] = 0;
+      }
+      // If we didn't find a valid candidate, the enumeration of all possible
+      // edge combinations (in the range) are done, we can return false.
+      if (!has_valid_candidate) return false;
+    }
+
+    // Next we perform the min ratio optimization, if it's used.
+    if (use_known_min_ratio_opt) {
+      OptResult opt = perform_min_ratio_optimization(known_min_ratio);
+      if (opt == OptResult::DONE)
+        return false;
+      else if (opt == OptResult::CONTINUE_SEARCH)
+        continue;
+    }
+
+    // Skip the state if an automorphism of the base graph maps it to an earlier state, together
+    // with the following states that only differ in the lowest digits.
+    int skip;
+    if (symmetry != nullptr && !symmetry->is_first(enum_state, skip)) {
+      ++stats_symmetry_skip;
+      for (int i = 0; i < std::min(skip, free_count); i++) {
+        enum_state[i] = Graph::K + 1;
       }
-      enum_state[i] = 0;
-    }
-    // If we didn't find a valid candidate, the enumeration of all possible
-    // edge combinations are done, we can return false.
-    if (!has_valid_candidate) return false;
-
-    // If we are not using min_theta optimization, since we already have a candidate, break out
-    // of the while loop to return the current candidate.
-    if (!use_known_min_theta_opt) break;
-
-    // Next we perform the min_theta optimization.
-    OptResult opt = perform_min_theta_optimization(known_min_theta);
-    if (opt == OptResult::FOUND_CANDIDATE)
-      break;  // Passed the min_theta optimization check, we have a winner.
-    else if (opt == OptResult::DONE)
-      return false;
-    else
       continue;
+    }
+
+    // We have a winner.
+    break;
   }
 
-  // We found a new valid enumeration state. Generate a new graph into `copy`.
-  generate_graph(copy, 0);
+  // We found a new valid enumeration state. Generate a new graph into `copy`, or only update
+  // the changed edges if `copy` still holds the graph from the last call. The callers only
+  // modify the generated graphs by canonicalize(), which relabels the vertices.
+  if (&copy == generated_graph && !copy.is_canonical) {
+    update_graph(copy);
+  } else {
+    generate_graph(copy, 0);
+  }
+  generated_graph = &copy;
+  std::copy(enum_state, enum_state + candidates.edge_candidate_count, generated_state);
   ++stats_edge_sets;
   return true;
 }
+
+void EdgeGenerator::set_range(const EdgeSetRange& range) {
+  const int count = candidates.edge_candidate_count;
+  free_count = count - range.fixed_count;
+  at_range_start = false;
+  for (int i = 0; i < count; i++) {
+    enum_state[i] = i < free_count ? 0 : range.states[i];
+    // The first state has all the free digits 0. It's returned by the first next() call, unless
+    // it's the empty edge set.
+    if (enum_state[i] != 0) at_range_start = true;
+  }
+}
+
+int EdgeGenerator::split_range(int min_free_count, std::vector<EdgeSetRange>& split_ranges) {
+  assert(!at_range_start);
+  const size_t old_size = split_ranges.size();
+  // The edge sets after the current one either have the top free digit in its current state,
+  // and they stay in the range of this generator, or in a larger state. If there is no larger
+  // state, the next digit is tried.
+  while (free_count > min_free_count && split_ranges.size() == old_size) {
+    const int top = --free_count;
+    for (int s = enum_state[top] + 1; s < Graph::K + 2; s++) {
+      EdgeSetRange range;
+      range.fixed_count = candidates.edge_candidate_count - top;
+      std::copy(enum_state + top, enum_state + candidates.edge_candidate_count,
+                range.states + top);
+      range.states[top] = s;
+      split_ranges.push_back(range);
+    }
+  }
+  return split_ranges.size() - old_size;
+}
+
+void EdgeGenerator::update_graph(Graph& copy) const {
+  int highest = candidates.edge_candidate_count - 1;
+  while (highest >= 0 && enum_state[highest] == generated_state[highest]) --highest;
+  // The new edges are added after the base edges, in the order of the candidates, so the edges
+  // of the candidates 0..highest are right after the base edges.
+  int old_count = 0;
+  int new_count = 0;
+  Edge new_edges[MAX_EDGES];
+  for (int j = 0; j <= highest; j++) {
+    if (generated_state[j] != 0) ++old_count;
+    if (enum_state[j] != 0) {
+      new_edges[new_count++] =
+          Edge(candidates.edge_candidates[j], candidates.edge_candidates_heads[j][enum_state[j]]);
+    }
+  }
+  assert(copy.get_edge_count() >= base.get_edge_count() + old_count);
+  copy.replace_edges(base.get_edge_count(), old_count, new_edges, new_count);
+}
 void EdgeGenerator::generate_graph(Graph& copy, int skip_front) const {
   base.copy_edges(copy);
   for (uint8 j = skip_front; j < candidates.edge_candidate_count; j++) {
@@ -114,37 +310,32 @@ void EdgeGenerator::generate_graph(Graph& copy, int skip_front) const {
   }
 }
 
-// Performs the min_theta optimization, and returns one of the three results.
+// Performs the min ratio optimization, and returns one of the three results.
 //
-// Idea of the min_theta optimization: given the base graph and the current enum state,
-// we know what theta value of the new graph, without generating the new graph. If the
-// theta value is >= the currently known min_theta value, then the new graph is not interesting
-// to us, regardless whether it's T_k free, because it won't be able to lower the min_theta
+// Idea of the min ratio optimization: given the base graph and the current enum state,
+// we know what ratio value of the new graph, without generating the new graph. If the
+// ratio value is >= the currently known min ratio value, then the new graph is not interesting
+// to us, regardless whether it's T_k free, because it won't be able to lower the min ratio
 // value anyway. So in such case, we can advance the enumeration state to the next possible
-// state that may give us a smaller theta value, skipping many states to make the algorithm
+// state that may give us a smaller ratio value, skipping many states to make the algorithm
 // computationally feasible. This is very important when the base graph is very sparse
 // and therefore the new graphs are less likely to contain T_k, making the
 // `notify_contain_tk_skip` optimization less effective.
-EdgeGenerator::OptResult EdgeGenerator::perform_min_theta_optimization(Fraction known_min_theta) {
-  // The number of new edges must satisfy the following inequality in order
-  // for it to be interesting:
-  //    base_undirected + known_min_theta * (base_directed + new_edges) > binom_nk
-  // because otherwise, even if all new edges are directed, the theta produced would still
-  // be >= min_theta. Rewrite the inequility as
-  //    new_edges > (binom_nk - base_undirected) / known_min_theta - base_directed
-  // Thus
-  //    new_edges > floor((binom_nk - base_undirected) / known_min_theta) - base_directed
-  int new_edge_threshold = (Graph::TOTAL_EDGES - base.get_undirected_edge_count()) *
-                               known_min_theta.d / known_min_theta.n -
-                           base.get_directed_edge_count();
+//
+// The examples below are for theta_ratio, where the better state of an edge is directed (see
+// RatioBound). For zeta_ratio it's undirected, which only changes the second step.
+EdgeGenerator::OptResult EdgeGenerator::perform_min_ratio_optimization(Fraction known_min_ratio) {
+  if (known_min_ratio != threshold_min_ratio) {
+    update_min_ratio_thresholds(known_min_ratio);
+  }
   std::tuple<uint8, uint8, uint8, uint8> new_edge_info = count_edges();
   uint8 new_edges = std::get<0>(new_edge_info);
   uint8 new_directed_edges = std::get<1>(new_edge_info);
   uint8 low_non_edge_idx = std::get<2>(new_edge_info);
-  uint8 low_non_directed_idx = std::get<3>(new_edge_info);
+  uint8 low_non_better_idx = std::get<3>(new_edge_info);
 
-  // First step: check number of new edges. Details of this inequality check are described above
-  // in the `new_edge_threshold` calculation.
+  // First step: check number of new edges. Details of this inequality check are described in
+  // update_min_ratio_thresholds().
   if (new_edges <= new_edge_threshold) {
     ++stats_theta_edges_skip;
     // Here we can jump forward, to the state where it's ready to add another edge.
@@ -153,9 +344,9 @@ EdgeGenerator::OptResult EdgeGenerator::perform_min_theta_optimization(Fraction
     // is NOT [3, 0, 0, 1, 1, 2] (the normal increment), but rather, [3, 0, 1, 1, 1, 1].
     // Since the begin of the for loop above does increment, we put the enum state to
     // [3, 0, 1, 1, 1, 0], to prepare for the for loop increment to do the job.
-    if (low_non_edge_idx >= candidates.edge_candidate_count) {
-      // In this case, all edges are present and we still don't have enough edges, simply
-      // return DONE to terminate the generation.
+    if (low_non_edge_idx >= free_count) {
+      // In this case, all edges (that are not fixed by the range) are present and we still don't
+      // have enough edges, simply return DONE to terminate the generation.
       return OptResult::DONE;
     }
     for (uint8 i = 1; i <= low_non_edge_idx; i++) {
@@ -165,25 +356,48 @@ EdgeGenerator::OptResult EdgeGenerator::perform_min_theta_optimization(Fraction
     return OptResult::CONTINUE_SEARCH;
   }
   // If we get here, we have enough number of edges. But there still may not be enough number
-  // of directed edges. So just compute.
+  // of edges in the better state. So just compute.
+  // (If there is no directed edge, theta is infinity, which is also >= min ratio.)
   int total_directed = new_directed_edges + base.get_directed_edge_count();
   int total_undirected = new_edges - new_directed_edges + base.get_undirected_edge_count();
-  if (total_directed == 0 ||
-      known_min_theta <= Fraction(Graph::TOTAL_EDGES - total_undirected, total_directed)) {
+  if (bound->get_ratio_table().get_rank(total_undirected, total_directed) >=
+      threshold_ratio_rank) {
     ++stats_theta_directed_edges_skip;
     // Here we can jump forward similar to above when we don't have enough total edges,
     // to the state where it's ready to add another directed edge.
     // For example if the current enum state is [3, 0, 1, 2, 2, 2], and there are not
-    // enough directed edges, then the next enum state that may have enough new edges
+    // enough directed edges, then the next enum state that may have enough directed edges
     // is NOT [3, 0, 1, 2, 2, 3] (the normal increment), but rather, [3, 0, 2, 2, 2, 2].
     // Since the begin of the for loop above does increment, we put the enum state to
     // [3, 0, 2, 2, 2, 1], to prepare for the for loop increment to do the job.
-    if (low_non_directed_idx >= candidates.edge_candidate_count) {
-      // In this case, all edges are present and directed and we still don't have enough directed
-      // edges, simply return DONE to terminate the generation.
+    // This needs the edge at low_non_better_idx to be undirected. If it's absent instead,
+    // e.g. [3, 1, 0, 2, 2, 2], then [3, 1, 1, 2, 2, 2] has one more undirected edge and may
+    // produce a smaller theta, so we can only skip the other heads of the directed edges below
+    // it, which have the same edge counts, by putting the enum state to [3, 1, 0, K+1, K+1, K+1].
+    // (For zeta_ratio, the edges below it are undirected instead, and the states skipped this way
+    // have some of them directed, with fewer undirected edges.)
+    if (low_non_better_idx >= free_count) {
+      // In this case, all edges (that are not fixed by the range) are present and in the better
+      // state and we still don't have a smaller ratio, simply return DONE to terminate the
+      // generation.
       return OptResult::DONE;
     }
-    for (uint8 i = 1; i <= low_non_directed_idx; i++) {
+    if (enum_state[low_non_better_idx] == 0) {
+      for (uint8 i = 0; i < low_non_better_idx; i++) {
+        enum_state[i] = Graph::K + 1;
+      }
+      return OptResult::CONTINUE_SEARCH;
+    }
+    if (!bound->is_directed_better()) {
+      // For zeta_ratio, the edges below low_non_better_idx are undirected, and the edge at it is
+      // directed, e.g. [3, 1, 2, 1, 1, 1]. The states up to [3, 1, K+1, K+1, K+1, K+1] don't
+      // have more undirected edges, and don't have more edges, so they are all skipped.
+      for (uint8 i = 0; i <= low_non_better_idx; i++) {
+        enum_state[i] = Graph::K + 1;
+      }
+      return OptResult::CONTINUE_SEARCH;
+    }
+    for (uint8 i = 1; i <= low_non_better_idx; i++) {
       enum_state[i] = 2;
     }
     enum_state[0] = 1;
@@ -194,16 +408,58 @@ EdgeGenerator::OptResult EdgeGenerator::perform_min_theta_optimization(Fraction
   return OptResult::FOUND_CANDIDATE;
 }
 
+// Computes the thresholds of perform_min_ratio_optimization() for the given min ratio value.
+void EdgeGenerator::update_min_ratio_thresholds(Fraction known_min_ratio) {
+  threshold_min_ratio = known_min_ratio;
+  threshold_ratio_rank = bound->get_ratio_table().count_less(known_min_ratio);
+  // The number of new edges must satisfy the following inequality in order
+  // for it to be interesting (for theta_ratio):
+  //    (binom_nk - base_undirected) / (base_directed + new_edges) < known_min_ratio
+  // because otherwise, even if all new edges are directed, the theta produced would still
+  // be >= min ratio. The left side decreases as new_edges increases, so the threshold is the
+  // largest new_edges where it's still >= min ratio (or -1 if there is none).
+  int undirected = base.get_undirected_edge_count();
+  int directed = base.get_directed_edge_count();
+  new_edge_threshold = -1;
+  while (directed + undirected + new_edge_threshold + 1 <= Graph::TOTAL_EDGES &&
+         bound->min_rank(undirected, directed, new_edge_threshold + 1) >= threshold_ratio_rank) {
+    ++new_edge_threshold;
+  }
+}
+
 // Notify the generator about the fact that adding the current edge set to the graph
 // makes it contain T_k, and therefore we can skip edge sets that are supersets of the current.
-void EdgeGenerator::notify_contain_tk_skip() {
+// The same works for any forbidden subgraphs closed under adding edges, checked by `contains`.
+void EdgeGenerator::notify_contain_tk_skip(const CandidatesContainFunction& contains) {
   ++stats_tk_skip;
-  if (enum_state[0] == 0) {
+  if (use_tk_conflict_skip) {
+    // The caller checks T_k with the conflict tables, so we know all the minimal T_k-causing
+    // assignments in the current state, wherever their digits are, not only the lowest ones.
+    // Skip as far as the conflict with the furthest skip allows, see get_tk_conflict_skip().
+    // For example, if the enum state is [3,0,0,2,1,2,2] and the only conflict is the pair
+    // {3 at digit 6, any non-zero state at digit 3}, update it to [3,0,0,K+1,K+1,K+1,K+1], and
+    // the next call will get to [3,0,1,0,0,0,0].
+    uint64 candidate_mask = 0;
+    for (int i = 0; i < candidates.edge_candidate_count; i++) {
+      if (enum_state[i] != 0) candidate_mask |= 1ull << i;
+    }
+    const int skip = get_tk_conflict_skip(candidate_mask);
+    // The rule below only skips the digits below the lowest non-zero digit.
+    const int lowest = __builtin_ctzll(candidate_mask);
+    if (skip > lowest) {
+      ++stats_tk_conflict_skip;
+      stats_tk_conflict_skip_bits += skip - lowest;
+    }
+    for (int i = 0; i < std::min(skip, free_count); i++) {
+      enum_state[i] = Graph::K + 1;
+    }
+    stats_tk_skip_bits += skip;
+  } else if (enum_state[0] == 0) {
     // Find the lowest non-zero enum state, and change everything below
     // it to the final state. Then the next() call will bump the lowest non-zero enum state.
     // For example, if the enum state is [3,0,0,1,0,0,0], update it to [3,0,0,1,k+1,k+1,k+1]
     // then the next call will get to [3,0,0,2,0,0,0].
-    for (uint8 i = 0; i < candidates.edge_candidate_count; i++) {
+    for (int i = 0; i < free_count; i++) {
       if (enum_state[i] != 0) return;
       enum_state[i] = Graph::K + 1;
       ++stats_tk_skip_bits;
@@ -227,35 +483,175 @@ void EdgeGenerator::notify_contain_tk_skip() {
     // therefore perform the skipping implemented in the "if" branch above, so [3,0,0,2,2,2,2]
     // would never occur.
     //
-    // However if the min_theta optmization occurred (see `perform_min_theta_optimization()`
+    // However if the min_theta optmization occurred (see `perform_min_ratio_optimization()`
     // function), then it's possible that [3,0,0,1,1,1,1] or [3,0,0,2,2,2,2] is encountered
     // without ever encountering [3,0,0,2,2,0,0]. So without the code below, we would miss the
     // opportunity to skip a large number of candidate graphs. In fact it was observed that
     // after min_theta optimization was added, before adding this block of code, the code became
     // much faster for sparse base graphs, but also became much slower for dense base graphs.
     // This code block was added to specifically address the slow down.
-    Graph copy;
+    //
+    // For T_k, the graphs are never generated: each one is checked with the conflict tables,
+    // with the lowest remaining candidate removed from the candidate mask in each step. The
+    // other forbidden subgraphs are checked by `contains` with the same candidate masks.
+    uint64 candidate_mask = 0;
+    for (int i = 1; i < candidates.edge_candidate_count; i++) {
+      if (enum_state[i] != 0) candidate_mask |= 1ull << i;
+    }
     for (int skip_front = 1; skip_front < candidates.edge_candidate_count; skip_front++) {
-      generate_graph(copy, skip_front);
-      if (copy.get_edge_count() == base.get_edge_count()) return;
-      if (contains_Tk(copy, Graph::N - 1)) {
+      if (candidate_mask == 0) return;
+      // Once the digits are fixed by the range, all the free digits are already skipped.
+      if (skip_front > free_count) return;
+      if (contains != nullptr ? contains(candidate_mask)
+                              : contains_Tk_in_candidates(candidate_mask)) {
         enum_state[skip_front - 1] = Graph::K + 1;
         ++stats_tk_skip_bits;
       }
+      candidate_mask &= ~(1ull << skip_front);
     }
   }
 }
 
+void EdgeGenerator::notify_tk_free() {
+  has_free_state = true;
+  std::copy(enum_state, enum_state + candidates.edge_candidate_count, free_state);
+}
+
+int EdgeGenerator::get_new_edges_since_tk_free(Edge edges[]) const {
+  int count = 0;
+  for (int i = 0; i < candidates.edge_candidate_count; i++) {
+    if (enum_state[i] != 0 && !(has_free_state && enum_state[i] == free_state[i])) {
+      edges[count++] =
+          Edge(candidates.edge_candidates[i], candidates.edge_candidates_heads[i][enum_state[i]]);
+    }
+  }
+  return count;
+}
+
+// Precomputes the T_k conflicts among the candidate states for the base graph.
+void EdgeGenerator::build_tk_conflicts() {
+  const int v = candidates.n - 1;
+  const int count = candidates.edge_candidate_count;
+  const int states = Graph::K + 2;
+  assert(count <= 64);
+  has_tk_conflicts = true;
+  tk_pair_conflicts.assign(count * states, 0);
+  tk_triple_starts.assign(count * states + 1, 0);
+  tk_triple_conflicts.clear();
+
+  // The index of each candidate by the rank of its vertex set.
+  uint8 candidate_index[MAX_EDGES];
+  for (int i = 0; i < count; i++) {
+    candidate_index[Graph::EDGE_RANKS[candidates.edge_candidates[i]]] = i;
+  }
+  auto candidate_bit = [&candidate_index](uint16 vertex_set) {
+    return 1ull << candidate_index[Graph::EDGE_RANKS[vertex_set]];
+  };
+
+  for (int i = 0; i < count; i++) {
+    const uint16 e_i = candidates.edge_candidates[i];
+    // The absent state has no conflicts.
+    tk_triple_starts[i * states + 1] = tk_triple_conflicts.size();
+    for (int s = 1; s < states; s++) {
+      const int index = i * states + s;
+      const uint8 head = candidates.edge_candidates_heads[i][s];
+      // Each T_k with candidate i is in mask = e_i + w, for a vertex w not in e_i.
+      for (int w = 0; w < v; w++) {
+        if ((e_i & (1 << w)) != 0) continue;
+        const uint16 mask = e_i | (1 << w);
+        // Two candidates e_i, mask - u, and the base edge mask - v, where xyz = {w, u, v}.
+        const int base_rank = Graph::EDGE_RANKS[mask & ~(1 << v)];
+        if (base.has_edge_rank(base_rank)) {
+          const uint8 base_head = base.get_head_rank(base_rank);
+          for (uint16 m = e_i & ~(1 << v); m != 0; m &= m - 1) {
+            const int u = __builtin_ctz(m);
+            if ((base_head != UNDIRECTED && (base_head == w || base_head == u)) ||
+                (head != UNDIRECTED && (head == u || head == v))) {
+              tk_pair_conflicts[index] |= candidate_bit(mask & ~(1 << u));
+            }
+          }
+        }
+        // Three candidates e_i, mask - y, and mask - z, where xyz = {w, y, z}, and the head of
+        // e_i (which can't be w) is y or z.
+        if (head == UNDIRECTED || head == v) continue;
+        for (uint16 m = e_i & ~(1 << v) & ~(1 << head); m != 0; m &= m - 1) {
+          const int z = __builtin_ctz(m);
+          tk_triple_conflicts.push_back(candidate_bit(mask & ~(1 << head)) |
+                                        candidate_bit(mask & ~(1 << z)));
+        }
+      }
+      tk_triple_starts[index + 1] = tk_triple_conflicts.size();
+    }
+  }
+}
+
+bool EdgeGenerator::contains_Tk_in_candidates(uint64 candidate_mask) {
+  if (!has_tk_conflicts) build_tk_conflicts();
+  Counters::increment_graph_contains_Tk_tests();
+  for (uint64 m = candidate_mask; m != 0; m &= m - 1) {
+    const int i = __builtin_ctzll(m);
+    const int index = i * (Graph::K + 2) + enum_state[i];
+    if ((tk_pair_conflicts[index] & candidate_mask) != 0) return true;
+    for (uint32 t = tk_triple_starts[index]; t < tk_triple_starts[index + 1]; t++) {
+      if ((tk_triple_conflicts[t] & candidate_mask) == tk_triple_conflicts[t]) return true;
+    }
+  }
+  return false;
+}
+
+// Returns the number of the lowest digits that can be skipped, given the current state with the
+// candidates in candidate_mask contains T_k.
+int EdgeGenerator::get_tk_conflict_skip(uint64 candidate_mask) const {
+  int skip = 0;
+  for (uint64 m = candidate_mask; m != 0; m &= m - 1) {
+    const int i = __builtin_ctzll(m);
+    const int index = i * (Graph::K + 2) + enum_state[i];
+    // A pair conflict with a lower partner j keeps the conflict until digit j goes back to 0, so
+    // the digits up to j can be skipped, otherwise only the digits below i.
+    const uint64 pairs = tk_pair_conflicts[index] & candidate_mask;
+    if (pairs != 0) {
+      skip = std::max(skip, std::min(i, 64 - __builtin_clzll(pairs)));
+    }
+    for (uint32 t = tk_triple_starts[index]; t < tk_triple_starts[index + 1]; t++) {
+      if ((tk_triple_conflicts[t] & candidate_mask) == tk_triple_conflicts[t]) {
+        skip = std::max(skip, std::min(i, __builtin_ctzll(tk_triple_conflicts[t]) + 1));
+      }
+    }
+  }
+  return skip;
+}
+
+void EdgeGenerator::generate_graph_in_candidates(Graph& copy, uint64 candidate_mask) const {
+  base.copy_edges(copy);
+  for (uint64 m = candidate_mask; m != 0; m &= m - 1) {
+    const int i = __builtin_ctzll(m);
+    assert(enum_state[i] != 0);
+    copy.add_edge(
+        Edge(candidates.edge_candidates[i], candidates.edge_candidates_heads[i][enum_state[i]]));
+  }
+}
+
+bool EdgeGenerator::contains_Tk() {
+  use_tk_conflict_skip = true;
+  uint64 candidate_mask = 0;
+  for (int i = 0; i < candidates.edge_candidate_count; i++) {
+    if (enum_state[i] != 0) candidate_mask |= 1ull << i;
+  }
+  return contains_Tk_in_candidates(candidate_mask);
+}
+
 // Returns a tuple:
 //    first = number of edges in the current state,
 //    second = number of directed edges in the current state,
 //    third = lowest index in enum_state where the edge is not in the set.
-//    forth = lowest index in enum_state where the edge is undirected or not in the set.
+//    forth = lowest index in enum_state where the edge is not in the better state of the bound.
 std::tuple<uint8, uint8, uint8, uint8> EdgeGenerator::count_edges() const {
+  // The enumeration state of the better state, where all directed states are the same as 2.
+  const uint8 better = bound->is_directed_better() ? 2 : 1;
   uint8 edges = 0;
   uint8 directed = 0;
   uint8 first_non_edge = candidates.edge_candidate_count;
-  uint8 first_non_directed_edge = candidates.edge_candidate_count;
+  uint8 first_non_better_edge = candidates.edge_candidate_count;
   for (int i = 0; i < candidates.edge_candidate_count; i++) {
     if (enum_state[i] != 0) {
       ++edges;
@@ -266,12 +662,12 @@ std::tuple<uint8, uint8, uint8, uint8> EdgeGenerator::count_edges() const {
       first_non_edge = i;
     }
 
-    if (first_non_directed_edge == candidates.edge_candidate_count &&
-        (enum_state[i] == 0 || enum_state[i] == 1)) {
-      first_non_directed_edge = i;
+    if (first_non_better_edge == candidates.edge_candidate_count &&
+        std::min<uint8>(enum_state[i], 2) != better) {
+      first_non_better_edge = i;
     }
   }
-  return std::make_tuple(edges, directed, first_non_edge, first_non_directed_edge);
+  return std::make_tuple(edges, directed, first_non_edge, first_non_better_edge);
 }
 
 void EdgeGenerator::print_debug(std::ostream& os, bool print_candidates, int base_graph_id) const {
@@ -288,4 +684,386 @@ void EdgeGenerator::print_debug(std::ostream& os, bool print_candidates, int bas
     os << "}";
   }
   os << "]\n";
-}
\ No newline at end of file
+}
+
+EdgeSearcher::EdgeSearcher(const EdgeCandidates& edge_candidates, const Graph& base_graph)
+    : stats_edges_placed(0),
+      stats_forbidden_prunes(0),
+      stats_theta_prunes(0),
+      stats_symmetry_prunes(0),
+      stats_edge_sets(0),
+      candidates(edge_candidates),
+      base(base_graph),
+      graph(nullptr),
+      contains(nullptr),
+      visit(nullptr),
+      bound(&RatioBound::THETA),
+      min_ratio(0, 1),
+      min_ratio_rank(0),
+      symmetry(nullptr) {
+  for (int i = 0; i < candidates.edge_candidate_count; i++) {
+    state[i] = 0;
+  }
+}
+
+void EdgeSearcher::clear_stats() {
+  stats_edges_placed = stats_forbidden_prunes = stats_theta_prunes = stats_symmetry_prunes =
+      stats_edge_sets = 0;
+}
+
+void EdgeSearcher::start_search(Graph& copy, const ContainsFunction& contains_) {
+  graph = &copy;
+  contains = &contains_;
+  base.copy_edges(copy);
+  for (int i = 0; i < candidates.edge_candidate_count; i++) {
+    state[i] = 0;
+  }
+  // Nothing is compared yet, starting from the highest candidate.
+  pending_images.clear();
+  for (int a = 0; symmetry != nullptr && a < symmetry->size(); a++) {
+    pending_images.push_back({static_cast<uint16>(a),
+                              static_cast<int8>(candidates.edge_candidate_count - 1)});
+  }
+}
+
+void EdgeSearcher::search(Graph& copy, Fraction known_min_ratio, const ContainsFunction& contains_,
+                          const VisitFunction& visit_) {
+  // The same as the min ratio optimization of EdgeGenerator, only used in the final step.
+  assert(candidates.n == Graph::N);
+  start_search(copy, contains_);
+  visit = &visit_;
+  min_ratio = known_min_ratio;
+  min_ratio_rank = bound != nullptr ? bound->get_ratio_table().count_less(known_min_ratio) : 0;
+  search_from(candidates.edge_candidate_count - 1, base.get_undirected_edge_count(),
+              base.get_directed_edge_count(), 0, pending_images.size());
+  graph = nullptr;
+}
+
+bool EdgeSearcher::search_target(Graph& copy, int undirected, int directed,
+                                 const ContainsFunction& contains_) {
+  assert(undirected >= 0 && directed >= 0 && undirected + directed > 0);
+  start_search(copy, contains_);
+  const bool found = search_target_from(candidates.edge_candidate_count - 1, undirected, directed,
+                                        0, pending_images.size());
+  graph = nullptr;
+  return found;
+}
+
+bool EdgeSearcher::has_earlier_image(int i, size_t begin, size_t end) {
+  for (size_t j = begin; j < end; j++) {
+    const int a = pending_images[j].automorphism;
+    int q = pending_images[j].position;
+    // Compare from the highest candidate not compared yet, as long as both the candidate and its
+    // source are placed.
+    int compare = 0;
+    for (; q >= i && symmetry->source(a, q) >= i; q--) {
+      const uint8 image = symmetry->image_state(a, q, state);
+      if (image != state[q]) {
+        compare = image < state[q] ? -1 : 1;
+        break;
+      }
+    }
+    if (compare < 0) {
+      pending_images.resize(end);
+      return true;
+    }
+    // If the image is the same as the state in all candidates, the automorphism doesn't help.
+    if (compare == 0 && q >= 0) {
+      pending_images.push_back({static_cast<uint16>(a), static_cast<int8>(q)});
+    }
+  }
+  return false;
+}
+
+void EdgeSearcher::search_from(int i, int undirected, int directed, size_t begin, size_t end) {
+  if (i < 0) {
+    // All candidates are decided. Like EdgeGenerator, the empty edge set is not visited.
+    if (graph->get_edge_count() == base.get_edge_count()) return;
+    assert(bound == nullptr || bound->min_rank(undirected, directed, 0) < min_ratio_rank);
+    ++stats_edge_sets;
+    Fraction new_min_ratio = (*visit)(*graph);
+    if (bound != nullptr && new_min_ratio != min_ratio) {
+      min_ratio = new_min_ratio;
+      min_ratio_rank = bound->get_ratio_table().count_less(new_min_ratio);
+    }
+    return;
+  }
+
+  const int base_count = base.get_edge_count();
+  for (int s = 0; s < Graph::K + 2; s++) {
+    // State 0 is absent, 1 is undirected, and the others are directed.
+    const int u = undirected + (s == 1 ? 1 : 0);
+    const int d = directed + (s >= 2 ? 1 : 0);
+    // The best possible ratio in the subtree is when all the i remaining candidates are in the
+    // better state. The known min ratio may become smaller while searching the previous states,
+    // so this is checked for every state.
+    if (bound != nullptr && bound->min_rank(u, d, i) >= min_ratio_rank) {
+      ++stats_theta_prunes;
+      continue;
+    }
+    state[i] = s;
+    if (symmetry != nullptr && has_earlier_image(i, begin, end)) {
+      ++stats_symmetry_prunes;
+      continue;
+    }
+    const size_t child_end = pending_images.size();
+    if (s == 0) {
+      search_from(i - 1, u, d, end, child_end);
+      pending_images.resize(end);
+      continue;
+    }
+    // The candidates are placed from the highest one, so the new edge goes right after the base
+    // edges, which keeps the edges in the same order as the graphs from EdgeGenerator.
+    const Edge edge(candidates.edge_candidates[i], candidates.edge_candidates_heads[i][s]);
+    graph->replace_edges(base_count, 0, &edge, 1);
+    ++stats_edges_placed;
+    if ((*contains)(*graph, edge)) {
+      ++stats_forbidden_prunes;
+    } else {
+      search_from(i - 1, u, d, end, child_end);
+    }
+    graph->replace_edges(base_count, 1, nullptr, 0);
+    pending_images.resize(end);
+  }
+  state[i] = 0;
+}
+
+bool EdgeSearcher::search_target_from(int i, int undirected, int directed, size_t begin,
+                                      size_t end) {
+  if (undirected == 0 && directed == 0) {
+    // The remaining candidates are all absent.
+    ++stats_edge_sets;
+    return true;
+  }
+
+  const int base_count = base.get_edge_count();
+  for (int s = 0; s < Graph::K + 2; s++) {
+    const int u = undirected - (s == 1 ? 1 : 0);
+    const int d = directed - (s >= 2 ? 1 : 0);
+    // The i remaining candidates must have all the remaining edges.
+    if (u < 0 || d < 0 || u + d > i) {
+      ++stats_theta_prunes;
+      continue;
+    }
+    state[i] = s;
+    if (symmetry != nullptr && has_earlier_image(i, begin, end)) {
+      ++stats_symmetry_prunes;
+      continue;
+    }
+    const size_t child_end = pending_images.size();
+    bool found = false;
+    if (s == 0) {
+      found = search_target_from(i - 1, u, d, end, child_end);
+    } else {
+      const Edge edge(candidates.edge_candidates[i], candidates.edge_candidates_heads[i][s]);
+      graph->replace_edges(base_count, 0, &edge, 1);
+      ++stats_edges_placed;
+      if ((*contains)(*graph, edge)) {
+        ++stats_forbidden_prunes;
+      } else {
+        found = search_target_from(i - 1, u, d, end, child_end);
+      }
+      if (!found) graph->replace_edges(base_count, 1, nullptr, 0);
+    }
+    pending_images.resize(end);
+    if (found) return true;
+  }
+  state[i] = 0;
+  return false;
+}
+
+void EdgeSearcher::print_debug(std::ostream& os, bool print_candidates, int base_graph_id) const {
+  os << "    EdgeSearcher[" << base_graph_id << ", state=";
+  for (int e = static_cast<int>(candidates.edge_candidate_count) - 1; e >= 0; e--) {
+    os << static_cast<int>(state[e]);
+  }
+  if (print_candidates) {
+    os << "\n      EC={";
+    for (int e = static_cast<int>(candidates.edge_candidate_count) - 1; e >= 0; e--) {
+      os << std::bitset<MAX_VERTICES>(candidates.edge_candidates[e]);
+      if (e > 0) os << ", ";
+    }
+    os << "}";
+  }
+  os << "]\n";
+}
+
+SkeletonSearcher::SkeletonSearcher(const EdgeCandidates& edge_candidates, const Graph& base_graph)
+    : stats_skeletons(0),
+      stats_forbidden_prunes(0),
+      stats_theta_prunes(0),
+      stats_edge_sets(0),
+      candidates(edge_candidates),
+      base(base_graph),
+      graph(nullptr),
+      solver(nullptr),
+      visit(nullptr),
+      progress(nullptr),
+      min_theta(0, 1),
+      min_theta_rank(0) {
+  for (int i = 0; i < candidates.edge_candidate_count; i++) {
+    state[i] = 0;
+  }
+}
+
+void SkeletonSearcher::clear_stats() {
+  stats_skeletons = stats_forbidden_prunes = stats_theta_prunes = stats_edge_sets = 0;
+}
+
+void SkeletonSearcher::search(Graph& copy, OrientationSolver& solver_, Fraction known_min_theta,
+                              const EdgeSearcher::VisitFunction& visit_,
+                              const ProgressFunction& progress_) {
+  assert(candidates.n == Graph::N);
+  graph = &copy;
+  solver = &solver_;
+  visit = &visit_;
+  progress = &progress_;
+  min_theta = known_min_theta;
+  min_theta_rank = Graph::THETA_RATIOS.count_less(known_min_theta);
+  search_from(candidates.edge_candidate_count - 1, 0);
+  graph = nullptr;
+  solver = nullptr;
+}
+
+bool SkeletonSearcher::search_target(Graph& copy, OrientationSolver& solver_, int undirected,
+                                     int directed, const ProgressFunction& progress_) {
+  assert(undirected >= 0 && directed >= 0 && undirected + directed > 0);
+  graph = &copy;
+  solver = &solver_;
+  progress = &progress_;
+  const bool found = search_target_from(candidates.edge_candidate_count - 1, 0,
+                                        undirected + directed, undirected, directed);
+  graph = nullptr;
+  solver = nullptr;
+  return found;
+}
+
+bool SkeletonSearcher::theta_bound_reached(int count, int remaining) const {
+  // The candidates that are undirected in every orientation stay undirected in the subtree, and
+  // all the others may be directed.
+  const int undirected = solver->min_undirected();
+  return Graph::THETA_RATIOS.get_rank(base.get_undirected_edge_count() + undirected,
+                                      base.get_directed_edge_count() + count - undirected +
+                                          remaining) >= min_theta_rank;
+}
+
+void SkeletonSearcher::search_from(int i, int count) {
+  if (i < 0) {
+    // Like EdgeGenerator, the empty edge set is not visited.
+    if (count == 0) return;
+    ++stats_skeletons;
+    (*progress)();
+    const int directed = solver->max_directed();
+    if (Graph::THETA_RATIOS.get_rank(base.get_undirected_edge_count() + count - directed,
+                                     base.get_directed_edge_count() + directed) >=
+        min_theta_rank) {
+      return;
+    }
+    // Generate the graph with the best orientation, with the edges in the same order as
+    // EdgeGenerator.
+    uint8 orientation[MAX_EDGES];
+    solver->orient(orientation);
+    base.copy_edges(*graph);
+    for (int j = 0; j < candidates.edge_candidate_count; j++) {
+      assert((orientation[j] != 0) == (state[j] != 0));
+      if (orientation[j] != 0) {
+        graph->add_edge(Edge(candidates.edge_candidates[j],
+                             candidates.edge_candidates_heads[j][orientation[j]]));
+      }
+    }
+    ++stats_edge_sets;
+    Fraction new_min_theta = (*visit)(*graph);
+    if (new_min_theta != min_theta) {
+      min_theta = new_min_theta;
+      min_theta_rank = Graph::THETA_RATIOS.count_less(new_min_theta);
+    }
+    return;
+  }
+
+  // Without candidate i. The known min_theta may become smaller while searching, so the bound is
+  // checked for each child.
+  if (theta_bound_reached(count, i)) {
+    ++stats_theta_prunes;
+  } else {
+    search_from(i - 1, count);
+  }
+
+  // With candidate i.
+  if (!solver->add(i)) {
+    ++stats_forbidden_prunes;
+    return;
+  }
+  if (theta_bound_reached(count + 1, i)) {
+    ++stats_theta_prunes;
+  } else {
+    state[i] = 1;
+    search_from(i - 1, count + 1);
+    state[i] = 0;
+  }
+  solver->remove(i);
+}
+
+bool SkeletonSearcher::search_target_from(int i, int count, int size, int undirected,
+                                          int directed) {
+  if (count == size) {
+    // The remaining candidates are all absent.
+    ++stats_skeletons;
+    (*progress)();
+    if (solver->max_directed() < directed) return false;
+    uint8 orientation[MAX_EDGES];
+    solver->orient(orientation);
+    int extra = solver->max_directed() - directed;
+    base.copy_edges(*graph);
+    for (int j = 0; j < candidates.edge_candidate_count; j++) {
+      if (orientation[j] >= 2 && extra > 0) {
+        orientation[j] = 1;
+        --extra;
+      }
+      if (orientation[j] != 0) {
+        graph->add_edge(Edge(candidates.edge_candidates[j],
+                             candidates.edge_candidates_heads[j][orientation[j]]));
+      }
+    }
+    ++stats_edge_sets;
+    return true;
+  }
+  // The i+1 remaining candidates must fill the skeleton.
+  if (count + i + 1 < size) {
+    ++stats_theta_prunes;
+    return false;
+  }
+
+  if (search_target_from(i - 1, count, size, undirected, directed)) return true;
+
+  if (!solver->add(i)) {
+    ++stats_forbidden_prunes;
+    return false;
+  }
+  bool found = false;
+  if (solver->min_undirected() > undirected) {
+    ++stats_theta_prunes;
+  } else {
+    state[i] = 1;
+    found = search_target_from(i - 1, count + 1, size, undirected, directed);
+    state[i] = 0;
+  }
+  solver->remove(i);
+  return found;
+}
+
+void SkeletonSearcher::print_debug(std::ostream& os, bool print_candidates,
+                                   int base_graph_id) const {
+  os << "    SkeletonSearcher[" << base_graph_id << ", state=";
+  for (int e = static_cast<int>(candidates.edge_candidate_count) - 1; e >= 0; e--) {
+    os << static_cast<int>(state[e]);
+  }
+  if (print_candidates) {
+    os << "\n      EC={";
+    for (int e = static_cast<int>(candidates.edge_candidate_count) - 1; e >= 0; e--) {
+      os << std::bitset<MAX_VERTICES>(candidates.edge_candidates[e]);
+      if (e > 0) os << ", ";
+    }
+    os << "}";
+  }
+  os << "]\n";
+}
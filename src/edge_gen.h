@@ -3,6 +3,21 @@
 
 constexpr uint8 NOT_IN_SET = 0x0E;
 
+// The orders of the edge candidates, i.e. which candidates are the low digits of the enumeration
+// state (see EdgeGenerator::enum_state). The low digits change most often, and the T_k skips only
+// skip the digits below the edges that cause the T_k, so the order changes how much is skipped.
+//
+// The degree of a candidate is the number of base edges containing its other K-1 vertices. Each
+// such base edge makes a T_k with the candidate and another candidate for some heads, so the
+// candidates with higher degrees are more likely to cause T_k.
+enum class CandidateOrder {
+  NATURAL,      // By the vertex set bitmasks of the candidates.
+  HIGH_DEGREE,  // By decreasing degrees, so the highest degree is digit 0.
+  // By increasing degrees. This skips the most in our experiments: the T_k are found when only
+  // a few high digits are set, and all the digits below them are skipped.
+  LOW_DEGREE,
+};
+
 // This struct holds all edge candidates that contain vertex (n-1).
 struct EdgeCandidates {
   const uint16 n;                     // Number of vertices after adding the new vertex.
@@ -15,6 +30,96 @@ struct EdgeCandidates {
   uint8 edge_candidates_heads[MAX_EDGES][MAX_VERTICES + 2];
 
   explicit EdgeCandidates(int num_vertices);
+
+  // Same as above, with the candidates in the given order for the base graph with
+  // num_vertices-1 vertices. The ties are kept in the natural order.
+  EdgeCandidates(int num_vertices, const Graph& base, CandidateOrder order);
+};
+
+// The automorphisms of a base graph that fix the new vertex (n-1), acting on the enumeration
+// states of the edge candidates (see EdgeGenerator::enum_state). An automorphism maps each edge
+// set to another edge set, and the base graph with the two edge sets are isomorphic, so they have
+// the same ratio and either both or neither contain a forbidden subgraph. Thus it's enough to
+// search the edge sets that come first in the enumeration order among their images, which skips
+// up to |Aut| times fewer edge sets for symmetric base graphs (e.g. the empty graph).
+//
+// The enumeration order compares the states from the highest candidate down, like an odometer.
+class CandidateSymmetry {
+ public:
+  // At most this many automorphisms (other than the identity) are used. If the base graph has
+  // more, the edge sets skipped by the ones used are still isomorphic to an earlier edge set,
+  // only fewer edge sets are skipped.
+  static constexpr size_t MAX_AUTOMORPHISMS = 5040;
+
+  // Computes the automorphisms of the base graph with Graph::compute_automorphisms().
+  CandidateSymmetry(const EdgeCandidates& edge_candidates, const Graph& base);
+
+  // Returns the number of automorphisms used.
+  int size() const { return automorphism_count; }
+
+  // Returns the candidate mapped to candidate q by automorphism a.
+  uint8 source(int a, int q) const { return sources[a * candidate_count + q]; }
+  // Returns the state of candidate q in the image of the enumeration `state` by automorphism a.
+  uint8 image_state(int a, int q, const uint8 state[]) const {
+    const int i = a * candidate_count + q;
+    return image_states[i * (Graph::K + 2) + state[sources[i]]];
+  }
+
+  // Returns true if no automorphism maps the enumeration `state` to an earlier state. Otherwise
+  // returns false, and `skip` is set to the number of the lowest digits that can be skipped:
+  // every state that only differs from `state` in these digits also has an earlier image.
+  bool is_first(const uint8 state[], int& skip) const;
+
+ private:
+  int candidate_count;
+  int automorphism_count;
+  // Indexed by a * candidate_count + q, see source().
+  std::vector<uint8> sources;
+  // Indexed by (a * candidate_count + q) * (K+2) + s: the state of candidate q in the image, when
+  // candidate source(a, q) is in state s.
+  std::vector<uint8> image_states;
+};
+
+// A lower bound of the ratio of the graphs reachable from a partial edge set, used to skip the
+// edge sets that can't give a smaller ratio than the known min ratio in the final enumeration
+// phase (see EdgeGenerator::next() and EdgeSearcher::search()).
+//
+// The ratio must only depend on the numbers of undirected and directed edges, and be monotone in
+// each edge: an absent edge gives the highest ratio, and one of the undirected and the directed
+// edge (the better state) gives a ratio <= the other, with the same other edges. So a graph
+// with fewer edges, or with fewer edges in the better state and no more edges in total, never
+// has a smaller ratio. For example:
+//   theta_ratio = (binom_nk - u) / d: directed is better, since theta >= 1.
+//   zeta_ratio = (binom_nk - d) / u: undirected is better, since zeta >= 1.
+class RatioBound {
+ public:
+  virtual ~RatioBound() = default;
+
+  // Returns the table of the ratio values.
+  virtual const RatioTable& get_ratio_table() const = 0;
+
+  // Returns true if the better state of an edge is directed, false if it's undirected.
+  virtual bool is_directed_better() const = 0;
+
+  // Returns the lowest rank (in the ratio table) of the graphs with the given numbers of
+  // undirected and directed edges, plus up to `free_edges` more edges in any states. Requires
+  // undirected + directed + free_edges <= binom_nk.
+  virtual int min_rank(int undirected, int directed, int free_edges) const = 0;
+
+  // The bounds of theta_ratio (Graph::THETA_RATIOS) and zeta_ratio (Graph::ZETA_RATIOS), where
+  // all the free edges are in the better state.
+  static const RatioBound& THETA;
+  static const RatioBound& ZETA;
+};
+
+// A part of the enumeration of the edge sets of a base graph, used to split the work of one base
+// graph among the threads: the edge sets where the top `fixed_count` candidates (the most
+// significant digits of EdgeGenerator::enum_state) are in the given states. With fixed_count = 0,
+// it's the whole enumeration.
+struct EdgeSetRange {
+  int fixed_count = 0;
+  // The states of the candidates, only the top fixed_count of them are used.
+  uint8 states[MAX_EDGES];
 };
 
 // A helper class to generate all edge sets to add, when a new vertex is added to an existing graph.
@@ -31,7 +136,8 @@ class EdgeGenerator {
   //    first = number of edges in the current state,
   //    second = number of directed edges in the current state,
   //    third = lowest index in enum_state where the edge is not in the set.
-  //    forth = lowest index in enum_state where the edge is undirected or not in the set.
+  //    forth = lowest index in enum_state where the edge is not in the better state of the ratio
+  //            bound (see RatioBound), e.g. undirected or not in the set for theta_ratio.
   std::tuple<uint8, uint8, uint8, uint8> count_edges() const;
 
   // Generates a new graph in `copy` by:
@@ -41,26 +147,103 @@ class EdgeGenerator {
   // are skipped and not added to the new graph.
   void generate_graph(Graph& copy, int skip_front) const;
 
-  // Performs the min_theta optimization, and returns one of the three results.
+  // The graph generated by the last next() call, and the enumeration state it was generated
+  // from. Only used to compare with the `copy` of the next call, never dereferenced.
+  const Graph* generated_graph;
+  uint8 generated_state[MAX_EDGES];
+
+  // Updates `copy`, which was generated from generated_state, to the current enumeration state.
+  // Only the edges of the candidates up to the highest one whose state has changed are replaced.
+  // Usually that's only the lowest one or two candidates, since the enumeration state works like
+  // an odometer.
+  void update_graph(Graph& copy) const;
+
+  // The enumeration state of the last graph notified by notify_tk_free(), if has_free_state.
+  bool has_free_state;
+  uint8 free_state[MAX_EDGES];
+
+  // The T_k conflicts among the candidate states, precomputed from the base graph by
+  // build_tk_conflicts() on the first T_k check. Since the base graph has no edge containing the
+  // new vertex v, and at least two of the three edges of a T_k containing v also contain v, each
+  // T_k containing v is made of either two candidate edges and a base edge, or three candidate
+  // edges. So a single candidate state never forms a T_k with the base edges alone.
   //
-  // Idea of the min_theta optimization: given the base graph and the current enum state,
-  // we know what theta value of the new graph, without generating the new graph. If the
-  // theta value is >= the currently known min_theta value, then the new graph is not interesting
-  // to us, regardless whether it's T_k free, because it won't be able to lower the min_theta
+  // The tables are indexed by i*(K+2)+s, for candidate i in state s (see enum_state). For the
+  // T_k subgraphs where candidate i has state s and either the head of candidate i or the head
+  // of the base edge is in xyz (see contains_Tk()):
+  //   tk_pair_conflicts: the bitmask of the other candidates that form a T_k with candidate i
+  //       and a base edge, regardless of their states.
+  //   tk_triple_conflicts[tk_triple_starts[index] .. tk_triple_starts[index+1]): the bitmasks
+  //       of the other two candidates that form a T_k with candidate i, regardless of their
+  //       states. Here there is no base edge, so only the head of candidate i is in xyz.
+  // A T_k has at least one edge with the head in xyz, so it's found from that edge, and the
+  // graph contains T_k iff one of the present candidates has a conflict with present candidates.
+  bool has_tk_conflicts;
+  std::vector<uint64> tk_pair_conflicts;
+  std::vector<uint32> tk_triple_starts;
+  std::vector<uint64> tk_triple_conflicts;
+  void build_tk_conflicts();
+
+  // Set by contains_Tk(): the caller checks T_k with the conflict tables, so
+  // notify_contain_tk_skip() can use the tables to find the conflicts in the current state.
+  bool use_tk_conflict_skip;
+
+  // Returns the number of the lowest digits of the enumeration state that can be skipped (set to
+  // the final state), given the current state with the candidates in candidate_mask contains T_k.
+  // For each conflict in the state, every state that only differs in the digits below its
+  // lowest digit contains the same conflict. And if the lowest digit is a candidate that
+  // conflicts in any non-zero state (i.e. in the bitmask of a table entry), the states where
+  // that digit is larger also contain the conflict, so that digit can be skipped too. Returns
+  // the maximum over all conflicts in the state.
+  int get_tk_conflict_skip(uint64 candidate_mask) const;
+
+  // The number of the low digits of enum_state that are enumerated. The digits above them are
+  // fixed by set_range() or split_range(), and the enumeration is done when it would change them.
+  int free_count;
+  // True if next() should return the current state without incrementing it first, which is the
+  // first state of a range set by set_range(), unless it's the empty edge set.
+  bool at_range_start;
+
+  // If not null, the states that are not the first among their images are skipped.
+  const CandidateSymmetry* symmetry;
+
+  // The bound of the ratio used by the min ratio optimization.
+  const RatioBound* bound;
+
+  // Performs the min ratio optimization, and returns one of the three results.
+  //
+  // Idea of the min ratio optimization: given the base graph and the current enum state,
+  // we know what ratio value of the new graph, without generating the new graph. If the
+  // ratio value is >= the currently known min ratio value, then the new graph is not interesting
+  // to us, regardless whether it's T_k free, because it won't be able to lower the min ratio
   // value anyway. So in such case, we can advance the enumeration state to the next possible
-  // state that may give us a smaller theta value, skipping many states to make the algorithm
+  // state that may give us a smaller ratio value, skipping many states to make the algorithm
   // computationally feasible. This is very important when the base graph is very sparse
   // and therefore the new graphs are less likely to contain T_k, making the
   // `notify_contain_tk_skip` optimization less effective.
   enum class OptResult { FOUND_CANDIDATE = 0, CONTINUE_SEARCH = 1, DONE = 2 };
-  OptResult perform_min_theta_optimization(Fraction known_min_theta);
+  OptResult perform_min_ratio_optimization(Fraction known_min_ratio);
+
+  // The thresholds used by perform_min_ratio_optimization(), computed with the ratio bound from
+  // the known_min_ratio value of the last call. They are only recomputed when the value
+  // changes, i.e. when a smaller min ratio is found.
+  Fraction threshold_min_ratio;
+  // A new graph has ratio >= known_min_ratio iff its rank in the ratio table is >= this.
+  int threshold_ratio_rank;
+  // Adding at most this many new edges always gives ratio >= known_min_ratio, even if all of
+  // them are in the better state.
+  int new_edge_threshold;
+  void update_min_ratio_thresholds(Fraction known_min_ratio);
 
  public:
   // Some performance counters used to monitor the edge gen behavior.
   uint64 stats_tk_skip;           // How many notify_contain_tk_skip().
   uint64 stats_tk_skip_bits;      // How many bits in total did notify_contain_tk_skip() skip.
-  uint64 stats_theta_edges_skip;  // How many skips due to min_theta opt, not enough edges.
-  uint64 stats_theta_directed_edges_skip;  // How many skips due to min_theta opt, directed.
+  uint64 stats_tk_conflict_skip;  // How many skips beyond the lowest edge, by the conflicts.
+  uint64 stats_tk_conflict_skip_bits;  // How many bits in total did these skip beyond that.
+  uint64 stats_theta_edges_skip;  // How many skips due to min ratio opt, not enough edges.
+  uint64 stats_theta_directed_edges_skip;  // How many skips due to min ratio opt, better state.
+  uint64 stats_symmetry_skip;              // How many skips due to the base automorphisms.
   uint64 stats_edge_sets;                  // How many edge sets returned from this generator.
   void clear_stats();                      // Clear the above stats.
 
@@ -68,28 +251,321 @@ class EdgeGenerator {
   // vertex_count = number of vertices to grow to in each new graph.
   EdgeGenerator(const EdgeCandidates& edge_candidates, const Graph& base_graph);
 
+  // Skips the edge sets that an automorphism of the base graph maps to an earlier edge set, if
+  // `candidate_symmetry` is not null. It must be computed for the same candidates and base graph,
+  // and outlive the generator. This
+  // should only be used in the final enumeration phase, where isomorphic graphs give the same
+  // result.
+  void set_symmetry(const CandidateSymmetry* candidate_symmetry) { symmetry = candidate_symmetry; }
+
+  // Sets the bound of the ratio used by the min ratio optimization of next(), which is
+  // RatioBound::THETA by default. It must outlive the generator.
+  void set_ratio_bound(const RatioBound* ratio_bound) { bound = ratio_bound; }
+
+  // Restricts the enumeration to the edge sets in `range`. It must be called before the first
+  // next().
+  void set_range(const EdgeSetRange& range);
+
+  // Splits off some of the edge sets after the current one (the last one returned by next()), to
+  // be enumerated by other generators: fixes more of the top digits of the range of this
+  // generator to their current states, and adds the ranges of the larger states of the lowest
+  // newly fixed digit to `split_ranges`. Together with the new range of this generator, they
+  // have all the edge sets after the current one. Each new range has at least min_free_count
+  // digits that are not fixed. Returns the number of new ranges, which is 0 if the range of this
+  // generator has no more than min_free_count such digits left.
+  int split_range(int min_free_count, std::vector<EdgeSetRange>& split_ranges);
+
   // Generates the next edge set. Returns true enumeration should proceed,
   // in which case `copy` is the newly generated graph. (`copy` doesn't need to be clean before
   // calling this function, all its state will be reset.)
   // Returns false if all possibilities have already been enumerated.
   //
-  // use_known_min_theta_opt = whether min_theta optimization should be used. If false,
+  // If `copy` is the same graph as in the previous call, only the changed edges are updated,
+  // instead of copying the base graph and adding all new edges again. So the caller must not
+  // modify `copy` between the calls, except by canonicalize() (which is detected, and then the
+  // graph is generated again).
+  //
+  // use_known_min_ratio_opt = whether min ratio optimization should be used. If false,
   //    the rest of the paramters are all ignored.
-  // known_min_theta = the currently know min_theta value.
+  // known_min_ratio = the currently know min ratio value, of the ratio of set_ratio_bound().
   //
-  // The min_theta optimization: this should only be used in the final enumeration phase, not
+  // The min ratio optimization: this should only be used in the final enumeration phase, not
   // in the growth phase before the final step.
   //
-  // The idea is, if the graph is too sparse, then its theta is guaranteed to be larger than
-  // the currently known min_theta value, in which case we don't care about this graph since
-  // it won't give us a better min_theta value regardless whether the graph is T_k free.
-  bool next(Graph& copy, bool use_known_min_theta_opt = false,
-            Fraction known_min_theta = Fraction(0, 1));
+  // The idea is, if the graph is too sparse, then its ratio is guaranteed to be larger than
+  // the currently known min ratio value, in which case we don't care about this graph since
+  // it won't give us a better min ratio value regardless whether the graph is T_k free.
+  bool next(Graph& copy, bool use_known_min_ratio_opt = false,
+            Fraction known_min_ratio = Fraction(0, 1));
+
+  // Returns true if the base graph with the candidates in candidate_mask (in their current
+  // states) contains a forbidden subgraph with the new vertex. All candidates in the mask must be
+  // in the edge set.
+  using CandidatesContainFunction = std::function<bool(uint64 candidate_mask)>;
 
   // Notify the generator about the fact that adding the current edge set to the graph
   // makes it contain T_k, and therefore we can skip edge sets that are supersets of the current.
-  void notify_contain_tk_skip();
+  // If the caller checks T_k with contains_Tk(), the skip uses the conflict tables, so it can
+  // skip past any conflict in the current state, not only the lowest edges.
+  //
+  // The same works for any forbidden subgraphs closed under adding edges, with `contains` to
+  // check the subsets of the current edge set in the final step. If it's null, they are checked
+  // for T_k with the conflict tables (see contains_Tk_in_candidates()).
+  void notify_contain_tk_skip(const CandidatesContainFunction& contains = nullptr);
+
+  // Notify the generator that the graph of the current edge set doesn't contain T_k (or any
+  // forbidden subgraph through the new vertex). The current edge set is remembered for
+  // get_new_edges_since_tk_free().
+  void notify_tk_free();
+
+  // Stores in `edges` the edges of the current edge set whose candidate state differs from the
+  // last edge set notified by notify_tk_free(), and returns the number of such edges. Returns
+  // all edges of the current edge set if notify_tk_free() has not been called.
+  //
+  // The graph of the current edge set without these edges is a subgraph of the last T_k free
+  // graph (all the other candidates are either in both edge sets with the same head, or absent
+  // from both), so any T_k containing the new vertex must contain at least one of these edges.
+  // Since the enumeration state works like an odometer, usually there are only one or two.
+  int get_new_edges_since_tk_free(Edge edges[]) const;
+
+  // Returns true if the graph of the current edge set contains T_k with the new vertex, which is
+  // the same as contains_Tk(copy, n-1) for the last graph generated by next(), but only tests the
+  // conflict tables precomputed for the base graph with the bitmask of the current edge set.
+  bool contains_Tk();
+
+  // Returns true if the base graph with the candidates in candidate_mask (in their current states)
+  // contains T_k with the new vertex. All candidates in the mask must be in the edge set.
+  bool contains_Tk_in_candidates(uint64 candidate_mask);
+
+  // Generates in `copy` the base graph with the candidates in candidate_mask, in their current
+  // states.
+  void generate_graph_in_candidates(Graph& copy, uint64 candidate_mask) const;
 
   // Print the current state of this class to the given stream for debugging purpose.
   void print_debug(std::ostream& os, bool print_candidates, int base_graph_id) const;
 };
+
+// A depth-first branch-and-bound alternative to EdgeGenerator, for the final enumeration phase.
+//
+// EdgeGenerator walks the enumeration states like an odometer, and applies the min ratio and the
+// T_k skips after the fact. Instead, this class decides the states of the candidates
+// recursively, from the highest candidate (the most significant digit of the odometer) down to
+// candidate 0, trying the states of each candidate in increasing order. So the edge sets are
+// visited in the same order as EdgeGenerator::next(), and the graphs have their edges in the
+// same order. Two kinds of subtrees are pruned:
+//   (1) The forbidden subgraph is checked when each edge is placed, with the graph of the edges
+//       placed so far, which is known to be free of it without the new edge. If it's found, all
+//       the edge sets containing the placed edges are skipped at once.
+//   (2) Before a state is placed, the subtree is skipped if its best possible ratio (with all
+//       the remaining candidates in the better state, see RatioBound) is >= the known min ratio.
+//       This is the same check as in the min ratio optimization of EdgeGenerator.
+//   (3) With set_symmetry(), the subtree is skipped if an automorphism of the base graph maps all
+//       its edge sets to earlier ones, which is decided by the states placed so far.
+class EdgeSearcher {
+ public:
+  // Returns true if g contains a forbidden subgraph with the new vertex, after the given edge
+  // is added. g without the edge is known to have no such forbidden subgraph.
+  using ContainsFunction = std::function<bool(Graph& g, const Edge& edge)>;
+  // Called with each graph without a forbidden subgraph, whose ratio is less than the known
+  // min ratio. Returns the new known min ratio value.
+  using VisitFunction = std::function<Fraction(const Graph& g)>;
+
+  // Initializes the searcher for the given candidates and base graph.
+  EdgeSearcher(const EdgeCandidates& edge_candidates, const Graph& base_graph);
+
+  // Searches all non-empty edge sets, and calls `visit` with the graphs (generated in `copy`)
+  // without a forbidden subgraph and with ratio < known_min_ratio, where known_min_ratio starts
+  // from the given value and is updated by the return values of `visit`. This visits the same
+  // graphs as the loop of EdgeGenerator::next(copy, true, known_min_ratio) with the same ratio
+  // bound, skipping the graphs with a forbidden subgraph. Without a ratio bound, it visits all
+  // the graphs without a forbidden subgraph.
+  void search(Graph& copy, Fraction known_min_ratio, const ContainsFunction& contains,
+              const VisitFunction& visit);
+
+  // Decides whether there is an edge set with exactly `undirected` undirected and `directed`
+  // directed edges (not counting the base edges), at least one in total, without a forbidden
+  // subgraph. If so, returns true, and `copy` is the graph of the first such edge set in the
+  // enumeration order (or of an edge set isomorphic to it, with set_symmetry()).
+  bool search_target(Graph& copy, int undirected, int directed, const ContainsFunction& contains);
+
+  // Same as EdgeGenerator::set_symmetry(): skips the edge sets that an automorphism of the base
+  // graph maps to an earlier edge set, if `candidate_symmetry` is not null. So it still visits
+  // the same graphs as EdgeGenerator with the same symmetry.
+  void set_symmetry(const CandidateSymmetry* candidate_symmetry) { symmetry = candidate_symmetry; }
+
+  // Sets the bound of the ratio used by search(), which is RatioBound::THETA by default. If it's
+  // null, no subtree is pruned by the ratio.
+  void set_ratio_bound(const RatioBound* ratio_bound) { bound = ratio_bound; }
+
+  // Some performance counters used to monitor the search.
+  uint64 stats_edges_placed;    // How many candidate edges are placed.
+  uint64 stats_forbidden_prunes;  // How many subtrees are pruned by the forbidden subgraph.
+  uint64 stats_theta_prunes;    // How many subtrees are pruned by the min ratio or the target.
+  uint64 stats_symmetry_prunes;   // How many subtrees are pruned by the base automorphisms.
+  uint64 stats_edge_sets;       // How many edge sets are visited or found.
+  void clear_stats();           // Clear the above stats.
+
+  // Print the current state of this class to the given stream for debugging purpose.
+  void print_debug(std::ostream& os, bool print_candidates, int base_graph_id) const;
+
+ private:
+  const EdgeCandidates& candidates;  // The edge candidates used in the search.
+  const Graph& base;                 // The base graph to grow from.
+
+  // The states of the candidates on the current search path, the same as the enumeration state
+  // of EdgeGenerator. The candidates below the current one are 0.
+  uint8 state[MAX_EDGES];
+
+  // The arguments of the current search() call.
+  Graph* graph;
+  const ContainsFunction* contains;
+  const VisitFunction* visit;
+
+  // The bound of the ratio, or null.
+  const RatioBound* bound;
+  // The known min ratio, and its rank in the ratio table of the bound: a graph has ratio <
+  // min_ratio iff its rank is < min_ratio_rank.
+  Fraction min_ratio;
+  int min_ratio_rank;
+
+  // The automorphisms used to skip the edge sets, or null.
+  const CandidateSymmetry* symmetry;
+  // The automorphisms whose images of the states placed so far are the same as the placed states
+  // in all the candidates compared so far, with the highest candidate not compared yet. Each level
+  // of the search has a range of this array, and its children append theirs after it.
+  struct PendingImage {
+    uint16 automorphism;
+    int8 position;
+  };
+  std::vector<PendingImage> pending_images;
+  // Compares the images of the states placed so far (candidates i and above) by the automorphisms
+  // in pending_images[begin, end) with the placed states, as far as they are placed. Returns true
+  // if one image is earlier, so the subtree can be skipped. Otherwise appends the automorphisms
+  // with undecided comparisons after `end`.
+  bool has_earlier_image(int i, size_t begin, size_t end);
+
+  // Starts a search from the highest candidate, with the base edges in `copy`.
+  void start_search(Graph& copy, const ContainsFunction& contains);
+
+  // Searches the states of candidates i, i-1, ..., 0, where the graph has the base edges and the
+  // edges of the candidates above i, with the given numbers of undirected and directed edges.
+  // pending_images[begin, end) are the pending images of the states of the candidates above i.
+  void search_from(int i, int undirected, int directed, size_t begin, size_t end);
+
+  // Same as above for search_target(), where `undirected` and `directed` are the numbers of the
+  // edges still to be placed. Returns true when they are all placed, leaving the edges in the
+  // graph.
+  bool search_target_from(int i, int undirected, int directed, size_t begin, size_t end);
+};
+
+
+// The orientation problem of SkeletonSearcher for a base graph. The Grower subclasses implement
+// it for their forbidden subgraphs, see Grower::create_orientation_solver().
+//
+// A skeleton is a set of the edge candidates, without their heads. Theta only depends on the
+// numbers of undirected and directed edges, and for a fixed number of edges it's smaller with
+// more directed edges (since theta >= 1). So among the graphs with a given skeleton, the best
+// one is an orientation without a forbidden subgraph that has the most directed edges.
+class OrientationSolver {
+ public:
+  virtual ~OrientationSolver() = default;
+
+  // Adds candidate i to the skeleton. Returns false if every orientation of the skeleton with
+  // candidate i contains a forbidden subgraph (so does every skeleton containing it), in which
+  // case the skeleton is unchanged.
+  virtual bool add(int i) = 0;
+  // Removes candidate i from the skeleton, which must be the last candidate added.
+  virtual void remove(int i) = 0;
+
+  // Returns the maximum number of directed candidates, in an orientation of the skeleton without
+  // a forbidden subgraph.
+  virtual int max_directed() const = 0;
+  // Returns the number of the candidates in the skeleton that are undirected in every orientation
+  // without a forbidden subgraph, of the skeleton and of every skeleton containing it.
+  virtual int min_undirected() const = 0;
+
+  // Stores in `state` an orientation of the skeleton without a forbidden subgraph with
+  // max_directed() directed candidates, as the enumeration states of EdgeGenerator (the
+  // candidates not in the skeleton are 0).
+  virtual void orient(uint8 state[]) const = 0;
+};
+
+// Another alternative to EdgeGenerator for the final enumeration phase, which searches the
+// skeletons instead of the edge sets, and leaves the heads to an OrientationSolver.
+//
+// The skeletons are searched depth-first from the highest candidate down, like EdgeSearcher but
+// with only two states for each candidate, so there are 2^m skeletons instead of (K+2)^m edge
+// sets for m candidates. For each non-empty skeleton, the graph with the best orientation is
+// visited if its theta is less than the known min_theta. Two kinds of subtrees are pruned:
+//   (1) When a candidate is added, if every orientation of the skeleton contains a forbidden
+//       subgraph.
+//   (2) If the best possible theta in the subtree is >= the known min_theta, where all the
+//       remaining candidates and the candidates in the skeleton that can still be directed are
+//       directed.
+// So it finds the same min_theta for each base graph as EdgeGenerator, but the graph it visits
+// with the min_theta may be a different one.
+class SkeletonSearcher {
+ public:
+  // Called periodically during the search, to keep the time.
+  using ProgressFunction = std::function<void()>;
+
+  // Initializes the searcher for the given candidates and base graph.
+  SkeletonSearcher(const EdgeCandidates& edge_candidates, const Graph& base_graph);
+
+  // Searches all non-empty skeletons with the given solver, which must be created for the same
+  // candidates and base graph with an empty skeleton, and calls `visit` with the graphs (generated
+  // in `copy`) of the best orientations with theta < known_min_theta, where known_min_theta starts
+  // from the given value and is updated by the return values of `visit`. `progress` is called
+  // with each skeleton.
+  void search(Graph& copy, OrientationSolver& solver, Fraction known_min_theta,
+              const EdgeSearcher::VisitFunction& visit, const ProgressFunction& progress);
+
+  // Same as EdgeSearcher::search_target(), with the given solver, where `progress` is called with
+  // each skeleton with the target number of edges. The skeleton of `copy` is the first one in the
+  // enumeration order where the target is possible, and the lowest directed candidates of its
+  // best orientation are made undirected as needed, which never creates a forbidden subgraph.
+  bool search_target(Graph& copy, OrientationSolver& solver, int undirected, int directed,
+                     const ProgressFunction& progress);
+
+  // Some performance counters used to monitor the search.
+  uint64 stats_skeletons;         // How many non-empty skeletons are searched.
+  uint64 stats_forbidden_prunes;  // How many subtrees are pruned by the forbidden subgraph.
+  uint64 stats_theta_prunes;      // How many subtrees are pruned by the min_theta or the target.
+  uint64 stats_edge_sets;         // How many graphs are visited or found.
+  void clear_stats();             // Clear the above stats.
+
+  // Print the current state of this class to the given stream for debugging purpose.
+  void print_debug(std::ostream& os, bool print_candidates, int base_graph_id) const;
+
+ private:
+  const EdgeCandidates& candidates;  // The edge candidates used in the search.
+  const Graph& base;                 // The base graph to grow from.
+
+  // The states of the candidates on the current search path: 1 if in the skeleton, otherwise 0.
+  // The candidates below the current one are 0.
+  uint8 state[MAX_EDGES];
+
+  // The arguments of the current search() call.
+  Graph* graph;
+  OrientationSolver* solver;
+  const EdgeSearcher::VisitFunction* visit;
+  const ProgressFunction* progress;
+
+  // The known min_theta, and its rank in Graph::THETA_RATIOS: a graph has theta < min_theta iff
+  // its rank is < min_theta_rank.
+  Fraction min_theta;
+  int min_theta_rank;
+
+  // Returns true if no skeleton with the current `count` candidates and `remaining` more
+  // candidates can have theta < min_theta, see (2) above.
+  bool theta_bound_reached(int count, int remaining) const;
+
+  // Searches the skeletons with the candidates i, i-1, ..., 0, where the skeleton has `count`
+  // candidates above i.
+  void search_from(int i, int count);
+
+  // Same as above for search_target(), where the skeletons must have `size` candidates with at
+  // most `undirected` of them undirected. Returns true when one is found, after generating its
+  // graph with `directed` directed edges.
+  bool search_target_from(int i, int count, int size, int undirected, int directed);
+};
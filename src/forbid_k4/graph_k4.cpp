@@ -16,12 +16,12 @@ bool contains_K4(const Graph& g, int v) {
   bool neighbors_directed[MAX_VERTICES];  // Whether the neighbor is from a directed edge.
 
   // First find all neighbors of v (ignore edge direction).
-  for (uint8 e = 0; e < g.edge_count; e++) {
-    if ((g.edges[e].vertex_set & (1 << v)) != 0) {
-      // The edge contains the given vertex v. Find the other vertex u.
-      int u = __builtin_ctz(static_cast<uint32>(g.edges[e].vertex_set & ~(1 << v)));
+  for (int u = 0; u < Graph::N; u++) {
+    if (u == v) continue;
+    int rank = Graph::EDGE_RANKS[(1 << u) | (1 << v)];
+    if (g.has_edge_rank(rank)) {
       neighbors[neighbor_count] = u;
-      neighbors_directed[neighbor_count] = g.edges[e].head_vertex != UNDIRECTED;
+      neighbors_directed[neighbor_count] = g.get_head_rank(rank) != UNDIRECTED;
       ++neighbor_count;
     }
   }
@@ -32,26 +32,15 @@ bool contains_K4(const Graph& g, int v) {
   for (int i = 0; i < neighbor_count; i++) {
     for (int j = i + 1; j < neighbor_count; j++) {
       for (int k = j + 1; k < neighbor_count; k++) {
-        uint16 e_ij = (1 << neighbors[i]) | (1 << neighbors[j]);
-        uint16 e_jk = (1 << neighbors[j]) | (1 << neighbors[k]);
-        uint16 e_ki = (1 << neighbors[k]) | (1 << neighbors[i]);
-        bool has_ij = false, has_jk = false, has_ki = false;
-        bool directed_ij = false, directed_jk = false, directed_ki = false;
-        for (uint16 e = 0; e < g.edge_count; e++) {
-          if (g.edges[e].vertex_set == e_ij) {
-            has_ij = true;
-            directed_ij = g.edges[e].head_vertex != UNDIRECTED;
-          } else if (g.edges[e].vertex_set == e_jk) {
-            has_jk = true;
-            directed_jk = g.edges[e].head_vertex != UNDIRECTED;
-          } else if (g.edges[e].vertex_set == e_ki) {
-            has_ki = true;
-            directed_ki = g.edges[e].head_vertex != UNDIRECTED;
-          }
+        int rank_ij = Graph::EDGE_RANKS[(1 << neighbors[i]) | (1 << neighbors[j])];
+        int rank_jk = Graph::EDGE_RANKS[(1 << neighbors[j]) | (1 << neighbors[k])];
+        int rank_ki = Graph::EDGE_RANKS[(1 << neighbors[k]) | (1 << neighbors[i])];
+        if (!g.has_edge_rank(rank_ij) || !g.has_edge_rank(rank_jk) || !g.has_edge_rank(rank_ki)) {
+          continue;
         }
-        if (has_ij && has_jk && has_ki &&
-            (directed_ij || directed_jk || directed_ki || neighbors_directed[i] ||
-             neighbors_directed[j] || neighbors_directed[k])) {
+        if (g.get_head_rank(rank_ij) != UNDIRECTED || g.get_head_rank(rank_jk) != UNDIRECTED ||
+            g.get_head_rank(rank_ki) != UNDIRECTED || neighbors_directed[i] ||
+            neighbors_directed[j] || neighbors_directed[k]) {
           return true;
         }
       }
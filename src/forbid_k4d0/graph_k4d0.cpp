@@ -1,5 +1,7 @@
 #include "graph_k4d0.h"
 
+#include "../counters.h"
+
 // Returns true if the given graph g contains the complete transitive K4,
 //   F={01>1, 02>2, 03>3, 12>2, 13>3, 23>3},
 // and the given vertex v is a vertex in F. Only works for 2-PDGs (K=2).
@@ -8,7 +10,7 @@
 // (1) deleting vertices
 // (2) deleting edges
 // (3) changing undirected edges to directed edges.
-bool contains_K4D0(Graph& g, int v) {
+bool contains_K4D0(const Graph& g, int v) {
   // Applicable to the entire implementation of this function:
   //
   // In F={01>1, 02>2, 03>3, 12>2, 13>3, 23>3}, we'll call 0 the apex, and 123 the base.
@@ -18,9 +20,9 @@ bool contains_K4D0(Graph& g, int v) {
 
   assert(Graph::K == 2);  // This logic only works for 2-PDG
 
-  // We need the degree info on all vertices that may be the apex.
-  // Note this mutates `g`, and is the only reason why we can't use a `const Graph&`.
-  g.compute_vertex_signature();
+  // We need the degree info on all vertices that may be the apex. It is maintained by
+  // Graph::add_edge(), so there is no need to recompute it here.
+  Counters::increment_compute_vertex_signatures_avoided();
 
   // The total degree must be at least 3
   if (g.vertices[v].degree_undirected + g.vertices[v].degree_head + g.vertices[v].degree_tail < 3)
@@ -30,7 +32,7 @@ bool contains_K4D0(Graph& g, int v) {
   //
   // Aesthetic choice: we use a lambda here instead of declaring a separate function, to avoid
   // adding another friend function to the Graph class.
-  auto contains_K4D0_apex = [g, v](int apex) {
+  auto contains_K4D0_apex = [&g, v](int apex) {
     // Basic qualification of being apex.
     if (g.vertices[apex].degree_undirected + g.vertices[apex].degree_tail < 3) return false;
 
@@ -69,13 +71,13 @@ bool contains_K4D0(Graph& g, int v) {
       // Ignore unless either the apex or the 3-vertex base contains v.
       if (apex != v && (vertex_mask & (1 << v)) == 0) continue;
 
-      // Find all edges in the base. Since there are only 3 vertices, there are <=3 edges.
-      int base_edge_indices[3]{0};
+      // Look up the 3 edges in the base, one for each vertex removed from the 3-vertex base.
+      uint8 base_heads[3];
       int base_edge_count = 0;
-      for (int e = 0; e < g.edge_count; e++) {
-        if (__builtin_popcount(g.edges[e].vertex_set & vertex_mask) == 2) {
-          base_edge_indices[base_edge_count++] = e;
-        }
+      for (uint32 m = vertex_mask; m != 0; m &= m - 1) {
+        int rank = Graph::EDGE_RANKS[vertex_mask & ~(m & -m)];
+        if (!g.has_edge_rank(rank)) break;
+        base_heads[base_edge_count++] = g.get_head_rank(rank);
       }
       // Ignore if there are less than 3 edges in the base.
       if (base_edge_count < 3) continue;
@@ -84,15 +86,13 @@ bool contains_K4D0(Graph& g, int v) {
       // Recall the subgraph definition in the summary comment of this function.
       //
       // If there is any undirected edge, we have a transitive base.
-      if (g.edges[base_edge_indices[0]].head_vertex == UNDIRECTED ||
-          g.edges[base_edge_indices[1]].head_vertex == UNDIRECTED ||
-          g.edges[base_edge_indices[2]].head_vertex == UNDIRECTED) {
+      if (base_heads[0] == UNDIRECTED || base_heads[1] == UNDIRECTED ||
+          base_heads[2] == UNDIRECTED) {
         return true;
       }
       // Now all 3 edges are directed, we have a transitive base as long as it's not a 3-cycle.
-      if (g.edges[base_edge_indices[0]].head_vertex == g.edges[base_edge_indices[1]].head_vertex ||
-          g.edges[base_edge_indices[1]].head_vertex == g.edges[base_edge_indices[2]].head_vertex ||
-          g.edges[base_edge_indices[0]].head_vertex == g.edges[base_edge_indices[2]].head_vertex) {
+      if (base_heads[0] == base_heads[1] || base_heads[1] == base_heads[2] ||
+          base_heads[0] == base_heads[2]) {
         return true;
       }
     }
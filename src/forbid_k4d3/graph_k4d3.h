@@ -10,11 +10,12 @@
 // (1) deleting vertices
 // (2) deleting edges
 // (3) changing undirected edges to directed edges.
-bool contains_K4D3(Graph& g, int v);
+bool contains_K4D3(const Graph& g, int v);
 
 // Derived class to manage the growth search, for K4D3-free problem.
 class GrowerK4D3 : public Grower {
   using Grower::Grower;  // Inherite the constructor from the base class.
-  Fraction get_ratio(const Graph& g) const override { return g.get_zeta_ratio(); }
+  const RatioTable& get_ratio_table() const override { return Graph::ZETA_RATIOS; }
+  const RatioBound* get_ratio_bound() const override { return &RatioBound::ZETA; }
   bool contains_forbidden_subgraph(Graph& g, int v) const override { return contains_K4D3(g, v); }
 };
\ No newline at end of file
@@ -48,21 +48,23 @@ bool contains_Tk(const Graph& g, int v) {
       uint16 m = e_i ^ e_j;
       if (__builtin_popcount(m) == 2) {
         uint16 mask = m | g.edges[i].vertex_set;
-        for (int k = 0; k < g.edge_count; k++) {
-          if (k == i || k == j) continue;
+        // The third edge e_k must be a K-subset of mask other than e_i and e_j, namely mask
+        // minus one of the K-1 vertices in common = e_i & e_j. Instead of scanning all edges,
+        // look up each of these K-1 vertex sets in the edge bitmap.
+        for (uint16 common = e_i & e_j; common != 0; common &= common - 1) {
+          uint16 e_k = mask & ~(common & -common);
+          int rank_k = Graph::EDGE_RANKS[e_k];
+          if (!g.has_edge_rank(rank_k)) continue;
 
-          uint16 e_k = g.edges[k].vertex_set;
-          if (__builtin_popcount(mask ^ e_k) == 1) {
-            uint16 stem = m ^ e_k;
-            uint16 xyz = (e_i | e_j | e_k) & ~stem;
-            if ((g.edges[i].head_vertex != UNDIRECTED &&
-                 (xyz & (1 << g.edges[i].head_vertex)) != 0) ||
-                (g.edges[j].head_vertex != UNDIRECTED &&
-                 (xyz & (1 << g.edges[j].head_vertex)) != 0) ||
-                (g.edges[k].head_vertex != UNDIRECTED &&
-                 (xyz & (1 << g.edges[k].head_vertex)) != 0)) {
-              return true;
-            }
+          uint8 head_k = g.get_head_rank(rank_k);
+          uint16 stem = m ^ e_k;
+          uint16 xyz = (e_i | e_j | e_k) & ~stem;
+          if ((g.edges[i].head_vertex != UNDIRECTED &&
+               (xyz & (1 << g.edges[i].head_vertex)) != 0) ||
+              (g.edges[j].head_vertex != UNDIRECTED &&
+               (xyz & (1 << g.edges[j].head_vertex)) != 0) ||
+              (head_k != UNDIRECTED && (xyz & (1 << head_k)) != 0)) {
+            return true;
           }
         }
       }
@@ -70,3 +72,149 @@ bool contains_Tk(const Graph& g, int v) {
   }
   return false;
 }
+
+// Same as contains_Tk(), but only checks the T_k subgraphs containing at least one of the given
+// edges.
+bool contains_Tk_with_edges(const Graph& g, int v, const Edge edges[], int edge_count) {
+  Counters::increment_graph_contains_Tk_tests();
+
+  // The 3 edges of a T_k are 3 K-subsets of a (K+1)-set `mask`, and xyz is the set of the 3
+  // vertices of `mask` each missing from one of the edges (see contains_Tk()). So for the given
+  // edge e_c, mask = e_c + w for a vertex w not in e_c, and the other two edges are mask minus
+  // u_a and mask minus u_b for two vertices u_a, u_b in e_c, and xyz = {w, u_a, u_b}. Since v is
+  // in e_c, v is also in at least one of the other two edges, as required by contains_Tk().
+  for (int c = 0; c < edge_count; c++) {
+    uint16 e_c = edges[c].vertex_set;
+    uint8 head_c = edges[c].head_vertex;
+    assert((e_c & (1 << v)) != 0);
+    for (int w = 0; w < Graph::N; w++) {
+      if ((e_c & (1 << w)) != 0) continue;
+      uint16 mask = e_c | (1 << w);
+      // The vertices u in e_c where mask minus u is an edge, and the heads of these edges.
+      uint8 missing[MAX_VERTICES];
+      uint8 heads[MAX_VERTICES];
+      int count = 0;
+      for (uint16 m = e_c; m != 0; m &= m - 1) {
+        int u = __builtin_ctz(m);
+        int rank = Graph::EDGE_RANKS[mask & ~(1 << u)];
+        if (g.has_edge_rank(rank)) {
+          missing[count] = u;
+          heads[count] = g.get_head_rank(rank);
+          count++;
+        }
+      }
+      for (int a = 0; a < count; a++) {
+        for (int b = a + 1; b < count; b++) {
+          uint16 xyz = (1 << w) | (1 << missing[a]) | (1 << missing[b]);
+          if ((head_c != UNDIRECTED && (xyz & (1 << head_c)) != 0) ||
+              (heads[a] != UNDIRECTED && (xyz & (1 << heads[a])) != 0) ||
+              (heads[b] != UNDIRECTED && (xyz & (1 << heads[b])) != 0)) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+TkOrientationSolver::TkOrientationSolver(const EdgeCandidates& edge_candidates, const Graph& base)
+    : candidates(edge_candidates), skeleton(0), undirected(0) {
+  const int v = candidates.n - 1;
+  const int count = candidates.edge_candidate_count;
+  assert(count <= 64);
+  candidate_triangles.resize(count);
+  tk_conflicts.assign(count, 0);
+  for (int i = 0; i < count; i++) {
+    forbidden_heads[i] = 0;
+  }
+
+  // The index of each candidate by the rank of its vertex set.
+  uint8 candidate_index[MAX_EDGES];
+  for (int i = 0; i < count; i++) {
+    candidate_index[Graph::EDGE_RANKS[candidates.edge_candidates[i]]] = i;
+  }
+
+  // Each triangle has two candidates e_i and e_j in the (K+1)-set mask = e_i + e_j, and the third
+  // edge is mask minus a common vertex c, with xyz = (e_i ^ e_j) + c. It's a base edge iff c = v.
+  // The triangles of three candidates are found from their two lowest candidates.
+  for (int i = 0; i < count; i++) {
+    const uint16 e_i = candidates.edge_candidates[i];
+    for (int j = i + 1; j < count; j++) {
+      const uint16 e_j = candidates.edge_candidates[j];
+      if (__builtin_popcount(e_i ^ e_j) != 2) continue;
+      const uint16 mask = e_i | e_j;
+      for (uint16 m = e_i & e_j; m != 0; m &= m - 1) {
+        const int c = __builtin_ctz(m);
+        const uint16 e_k = mask & ~(1 << c);
+        const uint16 xyz = (e_i ^ e_j) | (1 << c);
+        Triangle t{(1ull << i) | (1ull << j),
+                   {static_cast<uint8>(i), static_cast<uint8>(j), 0},
+                   {static_cast<uint16>(xyz & e_i), static_cast<uint16>(xyz & e_j), 0}};
+        if (c == v) {
+          const int rank = Graph::EDGE_RANKS[e_k];
+          if (!base.has_edge_rank(rank)) continue;
+          const uint8 head = base.get_head_rank(rank);
+          if (head != UNDIRECTED && (xyz & (1 << head)) != 0) {
+            tk_conflicts[i] |= 1ull << j;
+            tk_conflicts[j] |= 1ull << i;
+            continue;
+          }
+        } else {
+          const int k = candidate_index[Graph::EDGE_RANKS[e_k]];
+          if (k < j) continue;
+          t.candidate_mask |= 1ull << k;
+          t.candidates[2] = k;
+          t.forbidden_heads[2] = xyz & e_k;
+        }
+        for (uint64 members = t.candidate_mask; members != 0; members &= members - 1) {
+          candidate_triangles[__builtin_ctzll(members)].push_back(triangles.size());
+        }
+        triangles.push_back(t);
+      }
+    }
+  }
+}
+
+bool TkOrientationSolver::add(int i) {
+  if ((tk_conflicts[i] & skeleton) != 0) return false;
+  skeleton |= 1ull << i;
+  change_starts.push_back(changes.size());
+  // The triangles completed by candidate i.
+  for (uint32 index : candidate_triangles[i]) {
+    const Triangle& t = triangles[index];
+    if ((t.candidate_mask & skeleton) != t.candidate_mask) continue;
+    for (int m = 0; m < __builtin_popcountll(t.candidate_mask); m++) {
+      const int j = t.candidates[m];
+      const uint16 forbidden = forbidden_heads[j] | t.forbidden_heads[m];
+      if (forbidden == forbidden_heads[j]) continue;
+      changes.push_back({j, forbidden_heads[j]});
+      forbidden_heads[j] = forbidden;
+      if ((candidates.edge_candidates[j] & ~forbidden) == 0) ++undirected;
+    }
+  }
+  return true;
+}
+
+void TkOrientationSolver::remove(int i) {
+  assert((skeleton & (1ull << i)) != 0);
+  for (size_t c = changes.size(); c > change_starts.back(); c--) {
+    const auto& [j, old_forbidden] = changes[c - 1];
+    if ((candidates.edge_candidates[j] & ~forbidden_heads[j]) == 0) --undirected;
+    forbidden_heads[j] = old_forbidden;
+  }
+  changes.resize(change_starts.back());
+  change_starts.pop_back();
+  skeleton &= ~(1ull << i);
+}
+
+void TkOrientationSolver::orient(uint8 state[]) const {
+  for (int i = 0; i < candidates.edge_candidate_count; i++) {
+    state[i] = 0;
+    if ((skeleton & (1ull << i)) == 0) continue;
+    // Undirected if no head is allowed, otherwise the lowest allowed head.
+    const uint16 e_i = candidates.edge_candidates[i];
+    const uint16 allowed = e_i & ~forbidden_heads[i];
+    state[i] = allowed == 0 ? 1 : 2 + __builtin_popcount(e_i & ((allowed & -allowed) - 1));
+  }
+}
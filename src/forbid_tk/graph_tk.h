@@ -15,9 +15,85 @@
 // (3) changing directed edges to undirected by forgetting directions.
 bool contains_Tk(const Graph& g, int v);
 
+// Same as contains_Tk(), but only checks the T_k subgraphs containing at least one of the given
+// edges, each of which must be an edge of g containing v. This is enough if g without these edges
+// is known to have no T_k containing v, e.g. when the edges are the only edges changed since a
+// graph that doesn't contain T_k.
+bool contains_Tk_with_edges(const Graph& g, int v, const Edge edges[], int edge_count);
+
+// The orientation problem of the skeleton search (see OrientationSolver) for T_k.
+//
+// A T_k containing the new vertex v is made of three edges of a (K+1)-set (see contains_Tk()),
+// at most one of which doesn't contain v, so it's either two candidates and a base edge, or three
+// candidates. Given a skeleton, every such "triangle" with all three edges present is a T_k iff
+// one of its edges has the head in xyz, namely one of the two vertices of xyz in the edge. So:
+//   (1) If the base edge of a triangle has the head in xyz, every skeleton with its two
+//       candidates contains T_k.
+//   (2) Otherwise each candidate in the skeleton can be directed independently, with any head
+//       except the vertices of xyz in the candidate, of all the triangles in the skeleton with it.
+// Thus the maximum number of directed candidates is the number of candidates in the skeleton
+// with an allowed head, which can only shrink when more candidates are added.
+class TkOrientationSolver : public OrientationSolver {
+ public:
+  // Precomputes the triangles with the given candidates and base graph.
+  TkOrientationSolver(const EdgeCandidates& edge_candidates, const Graph& base);
+
+  bool add(int i) override;
+  void remove(int i) override;
+  int max_directed() const override { return __builtin_popcountll(skeleton) - undirected; }
+  int min_undirected() const override { return undirected; }
+  void orient(uint8 state[]) const override;
+
+ private:
+  // The triangles with two or three candidates, where `candidate_mask` has their bits, and
+  // `forbidden_heads[j]` is the vertices of xyz in candidates[j].
+  struct Triangle {
+    uint64 candidate_mask;
+    uint8 candidates[3];
+    uint16 forbidden_heads[3];
+  };
+  const EdgeCandidates& candidates;
+  std::vector<Triangle> triangles;
+  // The triangles of each candidate, as indices into `triangles`.
+  std::vector<std::vector<uint32>> candidate_triangles;
+  // The bitmask of the other candidates of each candidate in the triangles of (1) above.
+  std::vector<uint64> tk_conflicts;
+
+  // The bitmask of the candidates in the skeleton.
+  uint64 skeleton;
+  // The vertices that can't be the head of each candidate, in the triangles in the skeleton.
+  uint16 forbidden_heads[MAX_EDGES];
+  // The number of the candidates in the skeleton where all the vertices are forbidden.
+  int undirected;
+  // The changes of forbidden_heads by each add() on the current skeleton, to be undone by
+  // remove(): the candidate and the old value, and where the changes of each add() start.
+  std::vector<std::pair<uint8, uint16>> changes;
+  std::vector<uint32> change_starts;
+};
+
 // Derived class to manage the growth search, for T_k-free problem.
 class GrowerTk : public Grower {
   using Grower::Grower;  // Inherite the constructor from the base class.
-  Fraction get_ratio(const Graph& g) const override { return g.get_theta_ratio(); }
+  const RatioTable& get_ratio_table() const override { return Graph::THETA_RATIOS; }
+  const RatioBound* get_ratio_bound() const override { return &RatioBound::THETA; }
   bool contains_forbidden_subgraph(Graph& g, int v) const override { return contains_Tk(g, v); }
+  bool contains_forbidden_subgraph_with_edges(Graph& g, int v, const Edge edges[],
+                                              int edge_count) const override {
+    return contains_Tk_with_edges(g, v, edges, edge_count);
+  }
+  bool contains_forbidden_subgraph_generated(Graph& g, int v,
+                                             EdgeGenerator& edge_gen) const override {
+    // The conflict tables of edge_gen are verified against contains_Tk() in debug builds.
+    bool result = edge_gen.contains_Tk();
+    assert(result == contains_Tk(g, v));
+    return result;
+  }
+  bool contains_forbidden_subgraph_in_candidates(int v, EdgeGenerator& edge_gen,
+                                                 uint64 candidate_mask) const override {
+    return edge_gen.contains_Tk_in_candidates(candidate_mask);
+  }
+  std::unique_ptr<OrientationSolver> create_orientation_solver(
+      const EdgeCandidates& edge_candidates, const Graph& base) const override {
+    return std::make_unique<TkOrientationSolver>(edge_candidates, base);
+  }
 };
\ No newline at end of file
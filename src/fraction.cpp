@@ -31,10 +31,3 @@ Fraction Fraction::epsilon() { return Fraction(1, 40320); }
 Fraction operator+(const Fraction& a, const Fraction& b) {
   return Fraction(a.n * b.d + a.d * b.n, a.d * b.d);
 }
-
-bool operator<(const Fraction& a, const Fraction& b) { return a.n * b.d < a.d * b.n; }
-bool operator>(const Fraction& a, const Fraction& b) { return b < a; }
-bool operator<=(const Fraction& a, const Fraction& b) { return !(b < a); }
-bool operator>=(const Fraction& a, const Fraction& b) { return !(a < b); }
-bool operator==(const Fraction& a, const Fraction& b) { return a.n == b.n && a.d == b.d; }
-bool operator!=(const Fraction& a, const Fraction& b) { return !(a == b); }
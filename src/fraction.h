@@ -22,12 +22,13 @@ struct Fraction {
 };
 
 Fraction operator+(const Fraction& a, const Fraction& b);
-bool operator<(const Fraction& a, const Fraction& b);
-bool operator<=(const Fraction& a, const Fraction& b);
-bool operator>(const Fraction& a, const Fraction& b);
-bool operator>=(const Fraction& a, const Fraction& b);
-bool operator==(const Fraction& a, const Fraction& b);
-bool operator!=(const Fraction& a, const Fraction& b);
+// The comparisons are inline, since they are used in the hot loops.
+inline bool operator<(const Fraction& a, const Fraction& b) { return a.n * b.d < a.d * b.n; }
+inline bool operator>(const Fraction& a, const Fraction& b) { return b < a; }
+inline bool operator<=(const Fraction& a, const Fraction& b) { return !(b < a); }
+inline bool operator>=(const Fraction& a, const Fraction& b) { return !(a < b); }
+inline bool operator==(const Fraction& a, const Fraction& b) { return a.n == b.n && a.d == b.d; }
+inline bool operator!=(const Fraction& a, const Fraction& b) { return !(a == b); }
 
 // Returns n choose k.
 constexpr int compute_binom(int n, int k) {
@@ -1,7 +1,7 @@
 #include "graph.h"
 
+#include "canonical_labeling.h"
 #include "counters.h"
-#include "permutator.h"
 
 // Combines value into the hash and returns the combined hash.
 uint64 hash_combine64(uint64 hash, uint64 value) {
@@ -92,6 +92,57 @@ void VertexSignature::print_vertices(std::ostream& os,
   os << "}\n";
 }
 
+// Builds the tables for the permutation p of the vertices 0..n-1. Each entry is computed from
+// the entry with the lowest vertex removed, so every entry takes a single OR.
+VertexSetPermutation::VertexSetPermutation(const int p[], int n) {
+  int low_count = 1 << std::min(n, 6);
+  low[0] = 0;
+  for (int s = 1; s < low_count; s++) {
+    low[s] = low[s & (s - 1)] | (1 << p[__builtin_ctz(s)]);
+  }
+  int high_count = 1 << std::max(n - 6, 0);
+  high[0] = 0;
+  for (int s = 1; s < high_count; s++) {
+    high[s] = high[s & (s - 1)] | (1 << p[6 + __builtin_ctz(s)]);
+  }
+}
+
+// Computes the ratios of all edge counts, then ranks the distinct values.
+void RatioTable::initialize(Kind kind, int total_edges_) {
+  total_edges = total_edges_;
+  ratios.clear();
+  for (int u = 0; u <= total_edges; u++) {
+    for (int d = 0; d <= total_edges; d++) {
+      int numerator = kind == Kind::THETA ? total_edges - u : total_edges - d;
+      int denominator = kind == Kind::THETA ? d : u;
+      // Edge counts with u + d > total_edges are not possible, and never looked up.
+      if (u + d > total_edges || denominator == 0) {
+        ratios.push_back(Fraction::infinity());
+      } else {
+        ratios.push_back(Fraction(numerator, denominator));
+      }
+    }
+  }
+  // Equal values are simplified to the same fraction, so they are equal as (n, d) pairs.
+  sorted_ratios = ratios;
+  std::sort(sorted_ratios.begin(), sorted_ratios.end());
+  sorted_ratios.erase(std::unique(sorted_ratios.begin(), sorted_ratios.end()),
+                      sorted_ratios.end());
+  ranks.clear();
+  for (const Fraction& f : ratios) {
+    ranks.push_back(std::lower_bound(sorted_ratios.begin(), sorted_ratios.end(), f) -
+                    sorted_ratios.begin());
+  }
+}
+
+int RatioTable::count_less(const Fraction& x) const {
+  return std::lower_bound(sorted_ratios.begin(), sorted_ratios.end(), x) - sorted_ratios.begin();
+}
+
+int RatioTable::count_at_most(const Fraction& x) const {
+  return std::upper_bound(sorted_ratios.begin(), sorted_ratios.end(), x) - sorted_ratios.begin();
+}
+
 // Global to all graph instances: number of vertices in each edge.
 int Graph::K = 0;
 // Global to all graph instances: total number of vertices in each graph.
@@ -100,6 +151,11 @@ int Graph::N = 0;
 int Graph::TOTAL_EDGES = 0;
 // Global to all graph instances: pre-computed the vertex masks, used in various computations.
 VertexMask Graph::VERTEX_MASKS[MAX_VERTICES + 1]{0};
+// Global to all graph instances: the rank of each vertex set with exactly K vertices.
+uint8 Graph::EDGE_RANKS[1 << MAX_VERTICES]{0};
+// Global to all graph instances: the theta_ratio and zeta_ratio values by the edge counts.
+RatioTable Graph::THETA_RATIOS;
+RatioTable Graph::ZETA_RATIOS;
 
 void Graph::set_global_graph_info(int k, int n) {
   K = k;
@@ -115,30 +171,32 @@ void Graph::set_global_graph_info(int k, int n) {
     }
     assert(mask.mask_count == compute_binom(n, m));
   }
+  // The edge bitmap in Graph can only hold ranks up to MAX_EDGES.
+  assert(TOTAL_EDGES <= MAX_EDGES);
+  for (int rank = 0; rank < VERTEX_MASKS[k].mask_count; rank++) {
+    EDGE_RANKS[VERTEX_MASKS[k].masks[rank]] = rank;
+  }
+  THETA_RATIOS.initialize(RatioTable::Kind::THETA, TOTAL_EDGES);
+  ZETA_RATIOS.initialize(RatioTable::Kind::ZETA, TOTAL_EDGES);
 }
 
-Graph::Graph() : graph_hash(0), is_canonical(false), edge_count(0), undirected_edge_count(0) {}
+Graph::Graph() : graph_hash(0), is_canonical(false), edge_count(0), undirected_edge_count(0) {
+  for (int v = 0; v < MAX_VERTICES; v++) {
+    vertices[v].reset(v);
+  }
+  clear_edge_bits();
+}
 
 // Returns theta_ratio = (binom_nk - (undirected edge count)) / (directed edge count).
 // In case directed edge count is 0, Fraction::infinity() is returned.
 Fraction Graph::get_theta_ratio() const {
-  uint8 directed = edge_count - undirected_edge_count;
-  if (directed > 0) {
-    return Fraction(TOTAL_EDGES - undirected_edge_count, directed);
-  } else {
-    return Fraction::infinity();
-  }
+  return THETA_RATIOS.get_ratio(undirected_edge_count, edge_count - undirected_edge_count);
 }
 
 // Returns zeta_ratio = (binom_nk - (directed edge count)) / (undirected edge count).
 // In case undirected edge count is 0, Fraction::infinity() is returned.
 Fraction Graph::get_zeta_ratio() const {
-  uint8 directed = edge_count - undirected_edge_count;
-  if (undirected_edge_count > 0) {
-    return Fraction(TOTAL_EDGES - directed, undirected_edge_count);
-  } else {
-    return Fraction::infinity();
-  }
+  return ZETA_RATIOS.get_ratio(undirected_edge_count, edge_count - undirected_edge_count);
 }
 
 // Returns the hash of this graph.
@@ -149,27 +207,93 @@ uint32 Graph::get_graph_hash() const {
 
 // Returns true if the edge specified by the bitmask of the vertices in the edge is allowed
 // to be added to the graph (this vertex set does not yet exist in the edges).
-bool Graph::edge_allowed(uint16 vertices) const {
-  for (uint8 i = 0; i < edge_count; i++) {
-    if (vertices == edges[i].vertex_set) return false;
-  }
-  return true;
-}
+bool Graph::edge_allowed(uint16 vertices) const { return !has_edge(vertices); }
 
 // Add an edge to the graph. It's caller's responsibility to make sure this is allowed.
 // And the input is consistent (head is inside the vertex set).
 void Graph::add_edge(Edge edge) {
 #if !NDEBUG
-  assert(edge_allowed(edge.vertex_set));
   assert(__builtin_popcount(edge.vertex_set) == K);
+  assert(edge_allowed(edge.vertex_set));
 #endif
   edges[edge_count++] = edge;
   if (edge.head_vertex == UNDIRECTED) {
     ++undirected_edge_count;
   }
+  set_edge_bits(edge);
+  // Keep the vertex degrees up to date, so they don't need to be recomputed from all edges.
+  update_vertex_degrees(edge, 1);
 }
 
-// Initializes everything in this graph from the edge set.
+// Adds delta (1 or -1) to the degrees of the vertices in the given edge.
+void Graph::update_vertex_degrees(Edge edge, int delta) {
+  if (edge.head_vertex == UNDIRECTED) {
+    for (uint32 m = edge.vertex_set; m != 0; m &= m - 1) {
+      vertices[__builtin_ctz(m)].degree_undirected += delta;
+    }
+  } else {
+    for (uint32 m = edge.vertex_set; m != 0; m &= m - 1) {
+      vertices[__builtin_ctz(m)].degree_tail += delta;
+    }
+    vertices[edge.head_vertex].degree_tail -= delta;
+    vertices[edge.head_vertex].degree_head += delta;
+  }
+}
+
+// Replaces the `old_count` edges starting at edges[start] with the given new edges, by removing
+// the old edges, moving the edges after them, then adding the new edges.
+void Graph::replace_edges(int start, int old_count, const Edge new_edges[], int new_count) {
+  assert(start + old_count <= edge_count);
+  assert(edge_count - old_count + new_count <= MAX_EDGES);
+  for (int i = start; i < start + old_count; i++) {
+    if (edges[i].head_vertex == UNDIRECTED) {
+      --undirected_edge_count;
+    }
+    unset_edge_bits(edges[i]);
+    update_vertex_degrees(edges[i], -1);
+  }
+  if (new_count != old_count) {
+    std::memmove(edges + start + new_count, edges + start + old_count,
+                 (edge_count - start - old_count) * sizeof(Edge));
+    edge_count += new_count - old_count;
+  }
+  for (int i = 0; i < new_count; i++) {
+    const Edge& edge = new_edges[i];
+#if !NDEBUG
+    assert(__builtin_popcount(edge.vertex_set) == K);
+    assert(!has_edge(edge.vertex_set));
+#endif
+    edges[start + i] = edge;
+    if (edge.head_vertex == UNDIRECTED) {
+      ++undirected_edge_count;
+    }
+    set_edge_bits(edge);
+    update_vertex_degrees(edge, 1);
+  }
+}
+
+// Clears the edge bitmap and the edge heads.
+void Graph::clear_edge_bits() {
+  for (uint64& bits : edge_bits) bits = 0;
+  for (uint64& heads : edge_heads) heads = 0;
+}
+
+// Adds the given edge to the edge bitmap and the edge heads.
+void Graph::set_edge_bits(Edge edge) {
+  int rank = EDGE_RANKS[edge.vertex_set];
+  edge_bits[rank >> 6] |= static_cast<uint64>(1) << (rank & 63);
+  edge_heads[rank >> 4] |= static_cast<uint64>(edge.head_vertex) << ((rank & 15) << 2);
+}
+
+// Removes the given edge from the edge bitmap and the edge heads.
+void Graph::unset_edge_bits(Edge edge) {
+  int rank = EDGE_RANKS[edge.vertex_set];
+  edge_bits[rank >> 6] &= ~(static_cast<uint64>(1) << (rank & 63));
+  edge_heads[rank >> 4] &= ~(static_cast<uint64>(0x0F) << ((rank & 15) << 2));
+}
+
+// Computes the vertex signatures from scratch using the edge set. Normally the signatures are
+// maintained incrementally by add_edge(), so this is only used to verify them in debug builds.
 void Graph::compute_vertex_signature() {
   Counters::increment_compute_vertex_signatures();
 
@@ -195,6 +319,55 @@ void Graph::compute_vertex_signature() {
   }
 }
 
+// Computes the codegree info for the vertex sets with 2 to K-1 vertices. Returns the hash of the
+// codegree info, and stores the hash of the vertex sets containing v in vertex_codegrees[v].
+uint64 Graph::compute_codegree_signature(uint64 vertex_codegrees[MAX_VERTICES]) const {
+  // The codegree info of each vertex set, indexed by the vertex set bitmask. The 3 counts
+  // (undirected, head in the set, head not in the set) are packed into one value the same way
+  // as VertexSignature::get_degrees(). Only the entries for the vertex sets used are cleared.
+  uint32 codegrees[1 << MAX_VERTICES];
+  for (int m = 2; m < K; m++) {
+    for (int i = 0; i < VERTEX_MASKS[m].mask_count; i++) {
+      codegrees[VERTEX_MASKS[m].masks[i]] = 0;
+    }
+  }
+  for (int i = 0; i < edge_count; i++) {
+    uint16 vertex_set = edges[i].vertex_set;
+    uint8 head = edges[i].head_vertex;
+    uint16 head_mask = head == UNDIRECTED ? 0 : static_cast<uint16>(1) << head;
+    // Loop through all proper subsets of the edge, skipping the single vertices.
+    for (uint16 s = (vertex_set - 1) & vertex_set; s != 0; s = (s - 1) & vertex_set) {
+      if ((s & (s - 1)) == 0) continue;
+      if (head == UNDIRECTED) {
+        codegrees[s] += 1 << 16;
+      } else if ((s & head_mask) != 0) {
+        codegrees[s] += 1 << 8;
+      } else {
+        codegrees[s] += 1;
+      }
+    }
+  }
+
+  // Sums of mixed values do not depend on the order of the vertex sets, so the hashes are
+  // invariant under isomorphisms.
+  uint64 hash = 0;
+  for (int v = 0; v < N; v++) {
+    vertex_codegrees[v] = 0;
+  }
+  for (int m = 2; m < K; m++) {
+    for (int i = 0; i < VERTEX_MASKS[m].mask_count; i++) {
+      uint16 vertex_set = VERTEX_MASKS[m].masks[i];
+      if (codegrees[vertex_set] == 0) continue;
+      uint64 value = mix_bits64(static_cast<uint64>(codegrees[vertex_set]) << 4 | m);
+      hash += value;
+      for (uint32 s = vertex_set; s != 0; s &= s - 1) {
+        vertex_codegrees[__builtin_ctz(s)] += value;
+      }
+    }
+  }
+  return hash;
+}
+
 // Returns a graph isomorphic to this graph, by applying vertex permutation.
 // The first parameter specifies the permutation. For example p={1,2,0,3} means
 //  0->1, 1->2, 2->0, 3->3.
@@ -202,24 +375,8 @@ void Graph::compute_vertex_signature() {
 void Graph::permute_for_testing(int p[], Graph& g) const {
   Counters::increment_graph_permute_ops();
 
-  // Copy the edges with permutation.
-  for (int i = 0; i < edge_count; i++) {
-    if (edges[i].head_vertex == UNDIRECTED) {
-      g.edges[i].head_vertex = UNDIRECTED;
-    } else {
-      g.edges[i].head_vertex = p[edges[i].head_vertex];
-    }
-    g.edges[i].vertex_set = 0;
-    for (int v = 0; v < N; v++) {
-      if ((edges[i].vertex_set & (1 << v)) != 0) {
-        g.edges[i].vertex_set |= (1 << p[v]);
-      }
-    }
-  }
-  // Copy the vertices
-  for (int v = 0; v < N; v++) {
-    g.vertices[v] = vertices[v];
-  }
+  // Copy the edges and the vertices with permutation.
+  permute_edges(p, g);
   g.edge_count = edge_count;
   g.undirected_edge_count = undirected_edge_count;
   g.finalize_edges();
@@ -229,74 +386,104 @@ void Graph::permute_for_testing(int p[], Graph& g) const {
 
 void Graph::permute_edges(int p[], Graph& g) const {
   g.edge_count = edge_count;
+  g.clear_edge_bits();
   // Copy the edges with permutation.
+  const VertexSetPermutation permutation(p, N);
   for (int i = 0; i < edge_count; i++) {
     if (edges[i].head_vertex == UNDIRECTED) {
       g.edges[i].head_vertex = UNDIRECTED;
     } else {
       g.edges[i].head_vertex = p[edges[i].head_vertex];
     }
-    g.edges[i].vertex_set = 0;
-    for (int v = 0; v < N; v++) {
-      if ((edges[i].vertex_set & (1 << v)) != 0) {
-        g.edges[i].vertex_set |= (1 << p[v]);
-      }
-    }
+    g.edges[i].vertex_set = permutation.apply(edges[i].vertex_set);
+    g.set_edge_bits(g.edges[i]);
+  }
+  // Copy the vertex signatures with permutation.
+  for (int v = 0; v < N; v++) {
+    g.vertices[p[v]] = vertices[v];
+    g.vertices[p[v]].vertex_id = p[v];
   }
 }
 
-// Performs a permutation of the vertices according to the given p array on this graph.
-// The first parameter specifies the permutation. For example p={1,2,0,3} means
-//  0->1, 1->2, 2->0, 3->3.
-// The second parameter is the resulting graph.
-// This graph must be canonicalized, and the permutation is guaranteed to perserve that.
-void Graph::permute_canonical(int p[], Graph& g) const {
-  Counters::increment_graph_permute_canonical_ops();
-
-  assert(is_canonical);
-  permute_edges(p, g);
-  g.finalize_edges();
-
-  g.graph_hash = graph_hash;
-  g.is_canonical = is_canonical;
-  g.undirected_edge_count = undirected_edge_count;
-}
-
-// Returns the canonicalized graph in g, where the vertices are ordered by their signatures.
+// Canonicalizes this graph, so that the vertices are ordered by their signatures, and isomorphic
+// graphs have identical canonical forms.
 void Graph::canonicalize() {
   Counters::increment_graph_canonicalize_ops();
 
-  // Compute the signatures before canonicalization.
+  // The vertex degrees are maintained by add_edge(), replace_edges() and copy_edges(), so there
+  // is no need to recompute them from the edges. Just label the vertices before sorting.
+  Counters::increment_compute_vertex_signatures_avoided();
+#if !NDEBUG
+  VertexSignature maintained[MAX_VERTICES];
+  std::copy(vertices, vertices + MAX_VERTICES, maintained);
   compute_vertex_signature();
-  // First get sorted vertex indices by the vertex signatures.
-  // Note we sort by descreasing order, to push vertices to lower indices.
-  std::sort(vertices, vertices + N, [this](const VertexSignature& a, const VertexSignature& b) {
-    return a.get_degrees() > b.get_degrees();
-  });
+  for (int v = 0; v < MAX_VERTICES; v++) {
+    assert(vertices[v].get_degrees() == maintained[v].get_degrees());
+  }
+#endif
+  for (int v = 0; v < MAX_VERTICES; v++) {
+    vertices[v].vertex_id = v;
+  }
+  uint64 vertex_codegrees[MAX_VERTICES];
+  uint64 codegree_hash = compute_codegree_signature(vertex_codegrees);
+  // First get sorted vertex indices by the vertex signatures, then by the codegree info.
+  // Note we sort the signatures by descreasing order, to push vertices to lower indices.
+  std::sort(vertices, vertices + N,
+            [&vertex_codegrees](const VertexSignature& a, const VertexSignature& b) {
+              if (a.get_degrees() != b.get_degrees()) {
+                return a.get_degrees() > b.get_degrees();
+              }
+              return vertex_codegrees[a.vertex_id] < vertex_codegrees[b.vertex_id];
+            });
+
+  // The sorted vertices are the initial partition of the canonical labeling search: vertices
+  // with the same degrees and codegree info are in the same cell. The canonical labeling keeps
+  // the cell order, so the vertex signatures remain sorted after relabeling.
+  uint8 cell_order[MAX_VERTICES];
+  uint16 cell_starts = 1;
+  bool codegree_split = false;
+  for (int v = 0; v < N; v++) {
+    cell_order[v] = vertices[v].vertex_id;
+    if (v > 0) {
+      if (vertices[v].get_degrees() != vertices[v - 1].get_degrees()) {
+        cell_starts |= 1 << v;
+      } else if (vertex_codegrees[vertices[v].vertex_id] !=
+                 vertex_codegrees[vertices[v - 1].vertex_id]) {
+        cell_starts |= 1 << v;
+        codegree_split = true;
+      }
+    }
+  }
+  if (codegree_split) {
+    Counters::increment_graph_isomorphic_codeg_diff();
+  }
+  CanonicalLabeling labeling(N, edge_count, edges, cell_order, cell_starts);
+  labeling.run();
+  Counters::observe_canonical_labeling(labeling.stats_leaves, labeling.stats_automorphisms);
 
-  // Now compute the inverse, which gives the permutation used to canonicalize.
+  // The permutation used to canonicalize.
   int p[MAX_VERTICES];
+  VertexSignature sorted[MAX_VERTICES];
+  std::copy(vertices, vertices + N, sorted);
   for (int v = 0; v < N; v++) {
-    p[vertices[v].vertex_id] = v;
+    p[v] = labeling.labels[v];
+    vertices[labeling.labels[sorted[v].vertex_id]] = sorted[v];
   }
 
-  uint64 hash = 0;
+  uint64 hash = codegree_hash;
   for (int v = 0; v < N; v++) {
     hash = hash_combine64(hash, vertices[v].get_degrees());
   }
   graph_hash = (hash >> 32) ^ hash;
 
+  clear_edge_bits();
+  const VertexSetPermutation permutation(p, N);
   for (int i = 0; i < edge_count; i++) {
-    uint16 vset = edges[i].vertex_set;
     if (edges[i].head_vertex != UNDIRECTED) {
       edges[i].head_vertex = p[edges[i].head_vertex];
     }
-    edges[i].vertex_set = 0;
-    for (int v = 0; v < N; v++) {
-      if ((vset & (1 << v)) != 0) {
-        edges[i].vertex_set |= (1 << p[v]);
-      }
-    }
+    edges[i].vertex_set = permutation.apply(edges[i].vertex_set);
+    set_edge_bits(edges[i]);
   }
 
   finalize_edges();
@@ -307,12 +494,20 @@ void Graph::canonicalize() {
 // isomorphism checks to be performed. The operation in this function is included in
 // canonicalize() so there is no need to call this function if canonicalize() is used.
 void Graph::finalize_edges() {
-  // Sort edges
-  std::sort(edges, edges + edge_count,
-            [](const Edge& a, const Edge& b) { return a.vertex_set < b.vertex_set; });
+  // Sort edges. The edge bitmap is indexed by the edge rank, which has the same order as the
+  // vertex sets, so listing the edges by increasing rank gives the sorted edges in linear time.
+  const uint16* masks = VERTEX_MASKS[K].masks;
+  int i = 0;
+  for (int word = 0; word < 2; word++) {
+    for (uint64 bits = edge_bits[word]; bits != 0; bits &= bits - 1) {
+      int rank = (word << 6) + __builtin_ctzll(bits);
+      edges[i++] = Edge(masks[rank], get_head_rank(rank));
+    }
+  }
+  assert(i == edge_count);
 }
 
-// Copy the edge info of this graph to g. It does not copy vertex signatures and graph hash.
+// Copy the edge info and the vertex degrees of this graph to g. It does not copy the graph hash.
 void Graph::copy_edges(Graph& g) const {
   Counters::increment_graph_copies();
 
@@ -323,6 +518,15 @@ void Graph::copy_edges(Graph& g) const {
   for (int i = 0; i < edge_count; i++) {
     g.edges[i] = edges[i];
   }
+  for (size_t i = 0; i < std::size(edge_bits); i++) {
+    g.edge_bits[i] = edge_bits[i];
+  }
+  for (size_t i = 0; i < std::size(edge_heads); i++) {
+    g.edge_heads[i] = edge_heads[i];
+  }
+  for (int v = 0; v < MAX_VERTICES; v++) {
+    g.vertices[v] = vertices[v];
+  }
 }
 
 // Returns true if this graph is isomorphic to the other.
@@ -336,38 +540,18 @@ bool Graph::is_isomorphic(const Graph& other) const {
     return false;
   }
 
-  // Opportunistic check, just in case the two graphs are identical without doing any permutation.
+  // Both graphs are in the canonical form, so they are isomorphic iff they are identical.
   if (is_identical(other)) {
     Counters::increment_graph_isomorphic_true();
     return true;
   }
-  Counters::increment_graph_isomorphic_expensive();
-
-  std::vector<std::pair<int, int>> perm_sets;
-  for (int v = 0; v < N - 1 && vertices[v].get_degrees() > 0; v++) {
-    if (vertices[v + 1].get_degrees() == vertices[v].get_degrees()) {
-      int t = v;
-      while (t < N && vertices[t].get_degrees() == vertices[v].get_degrees()) {
-        t++;
-      }
-      perm_sets.push_back(std::make_pair(v, t));
-      v = t - 1;
-    }
-  }
-
-  if (perm_sets.size() > 0) {
-    Permutator perm(move(perm_sets));
-    Graph h;
-    while (perm.next()) {
-      permute_canonical(perm.p, h);
-      if (h.is_identical(other)) {
-        Counters::increment_graph_isomorphic_true();
-        return true;
-      }
-    }
-  }
 
   Counters::increment_graph_isomorphic_hash_no();
+#if !NDEBUG
+  // Verify the canonical forms: the two graphs must not be isomorphic.
+  int p[MAX_VERTICES];
+  assert(!find_isomorphism(other, p));
+#endif
   return false;
 }
 
@@ -393,17 +577,127 @@ bool Graph::is_isomorphic_slow(const Graph& other) const {
   return false;
 }
 
+bool Graph::find_isomorphism(const Graph& other, int p[MAX_VERTICES]) const {
+  return search_isomorphisms(other, N, [p](const int q[]) {
+    std::copy(q, q + N, p);
+    return true;
+  });
+}
+
+// Computes the automorphisms of this graph that map each vertex >= n to itself, other than the
+// identity, up to max_count of them.
+void Graph::compute_automorphisms(
+    int n, size_t max_count, std::vector<std::array<uint8, MAX_VERTICES>>& automorphisms) const {
+  automorphisms.clear();
+  if (max_count == 0) return;
+  search_isomorphisms(*this, n, [&automorphisms, max_count](const int p[]) {
+    std::array<uint8, MAX_VERTICES> a;
+    bool is_identity = true;
+    for (int v = 0; v < MAX_VERTICES; v++) {
+      a[v] = v < N ? p[v] : v;
+      is_identity = is_identity && a[v] == v;
+    }
+    if (!is_identity) automorphisms.push_back(a);
+    return automorphisms.size() >= max_count;
+  });
+}
+
+bool Graph::search_isomorphisms(const Graph& other, int n,
+                                const std::function<bool(const int p[])>& found) const {
+  if (edge_count != other.edge_count || undirected_edge_count != other.undirected_edge_count) {
+    return false;
+  }
+  // The vertices in the other graph that each vertex can be mapped to: those with the same
+  // degrees, and only itself for the vertices >= n.
+  uint16 candidates[MAX_VERTICES];
+  for (int v = 0; v < N; v++) {
+    candidates[v] = 0;
+    for (int u = 0; u < N; u++) {
+      if (vertices[v].get_degrees() == other.vertices[u].get_degrees() && (v < n || u == v)) {
+        candidates[v] |= 1 << u;
+      }
+    }
+    if (candidates[v] == 0) return false;
+  }
+  // Map the vertices with fewer candidates first, as they have fewer choices to try.
+  int order[MAX_VERTICES];
+  for (int v = 0; v < N; v++) {
+    order[v] = v;
+  }
+  std::stable_sort(order, order + N, [&candidates](int a, int b) {
+    return __builtin_popcount(candidates[a]) < __builtin_popcount(candidates[b]);
+  });
+  // The edges to verify at each depth: those where order[depth] is the last vertex mapped.
+  // Every edge is verified exactly once, as soon as all its vertices are mapped.
+  uint8 depth_edge_count[MAX_VERTICES];
+  uint8 depth_edges[MAX_VERTICES][MAX_EDGES];
+  uint16 mapped = 0;
+  for (int d = 0; d < N; d++) {
+    mapped |= 1 << order[d];
+    depth_edge_count[d] = 0;
+    for (int i = 0; i < edge_count; i++) {
+      uint16 vertex_set = edges[i].vertex_set;
+      if ((vertex_set & ~mapped) == 0 && (vertex_set & (1 << order[d])) != 0) {
+        depth_edges[d][depth_edge_count[d]++] = i;
+      }
+    }
+  }
+
+  // Depth-first search. p is the current mapping, and remaining[d] holds the candidates of
+  // order[d] not yet tried.
+  int p[MAX_VERTICES];
+  uint16 remaining[MAX_VERTICES];
+  uint16 used = 0;
+  int d = 0;
+  remaining[0] = candidates[order[0]];
+  while (true) {
+    if (remaining[d] == 0) {
+      // All candidates tried, backtrack.
+      if (--d < 0) return false;
+      used &= ~(1 << p[order[d]]);
+      continue;
+    }
+    int u = __builtin_ctz(remaining[d]);
+    remaining[d] &= remaining[d] - 1;
+    p[order[d]] = u;
+    bool valid = true;
+    for (int j = 0; j < depth_edge_count[d] && valid; j++) {
+      const Edge& edge = edges[depth_edges[d][j]];
+      uint16 vertex_set = 0;
+      for (uint32 m = edge.vertex_set; m != 0; m &= m - 1) {
+        vertex_set |= 1 << p[__builtin_ctz(m)];
+      }
+      uint8 head = edge.head_vertex == UNDIRECTED ? UNDIRECTED : p[edge.head_vertex];
+      valid = other.has_edge(vertex_set) && other.get_head(vertex_set) == head;
+    }
+    if (!valid) continue;
+    // Both graphs have the same number of edges, so when all edges are mapped to edges in the
+    // other graph, the mapping is an isomorphism.
+    if (d == N - 1) {
+      if (found(p)) return true;
+      continue;
+    }
+    used |= 1 << u;
+    ++d;
+    remaining[d] = candidates[order[d]] & ~used;
+  }
+}
+
 // Returns true if the two graphs are identical (exactly same edge sets).
 bool Graph::is_identical(const Graph& other) const {
   Counters::increment_graph_identical_tests();
 
-  if (edge_count != other.edge_count) return false;
-  for (int i = 0; i < edge_count; i++) {
-    if (edges[i].vertex_set != other.edges[i].vertex_set ||
-        edges[i].head_vertex != other.edges[i].head_vertex)
-      return false;
+  // The edge bitmap and the edge heads determine the edge set, and unused bits are always 0, so
+  // it's enough to compare these 7 words instead of the edges array (this also makes the result
+  // independent of the order of the edges array). The first word of the bitmap is checked alone
+  // first, since non-identical graphs usually differ there. The other words are combined without
+  // branches, so the compiler can vectorize the comparison.
+  if (edge_bits[0] != other.edge_bits[0]) return false;
+  uint64 diff = edge_bits[1] ^ other.edge_bits[1];
+  for (size_t i = 0; i < std::size(edge_heads); i++) {
+    diff |= edge_heads[i] ^ other.edge_heads[i];
   }
-  return true;
+  return diff == 0;
 }
 
 // Used to establish a deterministic order when growing the search tree.
@@ -466,6 +760,10 @@ int parse_vertex_char(char c) {
 bool Graph::parse_edges(const std::string& edge_representation, Graph& result) {
   result.is_canonical = false;
   result.edge_count = result.undirected_edge_count = 0;
+  result.clear_edge_bits();
+  for (int v = 0; v < MAX_VERTICES; v++) {
+    result.vertices[v].reset(v);
+  }
 
   if (edge_representation.length() < 2) return false;
   if (edge_representation[0] != '{') return false;
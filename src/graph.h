@@ -72,6 +72,65 @@ struct VertexMask {
   uint16 masks[compute_binom(12, 6)];
 };
 
+// Lookup tables to apply a vertex permutation to vertex sets. The tables are built once per
+// permutation, then the image of a vertex set is the image of its low 6 bits OR'ed with the image
+// of its high 6 bits, instead of moving the bits one at a time.
+struct VertexSetPermutation {
+  // low[s] is the image of the vertex set s (vertices 0..5).
+  uint16 low[64];
+  // high[s] is the image of the vertex set s << 6 (vertices 6..11).
+  uint16 high[64];
+
+  // Builds the tables for the permutation p of the vertices 0..n-1, which maps v to p[v].
+  // Only the entries for vertex sets within 0..n-1 are filled.
+  VertexSetPermutation(const int p[], int n);
+
+  // Returns the image of the given vertex set.
+  uint16 apply(uint16 vertex_set) const { return low[vertex_set & 0x3F] | high[vertex_set >> 6]; }
+};
+
+// The ratio values (theta_ratio or zeta_ratio) of the graphs with N vertices, precomputed for all
+// possible (undirected, directed) edge counts, so that getting the ratio of a graph is a lookup
+// instead of constructing and simplifying a Fraction. Each distinct ratio value also gets a rank,
+// which is its index in the increasing order of the values, so that ratios can be compared by
+// comparing their ranks as integers.
+struct RatioTable {
+  // For a graph with u undirected edges and d directed edges:
+  //   theta_ratio = (binom_nk - u) / d, and zeta_ratio = (binom_nk - d) / u.
+  // The ratio is Fraction::infinity() if the denominator is 0.
+  enum class Kind { THETA, ZETA };
+
+  // Computes the table for the given kind, where total_edges is binom_nk.
+  void initialize(Kind kind, int total_edges);
+
+  // Returns the ratio, or the rank of the ratio, of a graph with the given edge counts.
+  const Fraction& get_ratio(int undirected, int directed) const {
+    return ratios[index(undirected, directed)];
+  }
+  int get_rank(int undirected, int directed) const { return ranks[index(undirected, directed)]; }
+  // Returns the ratio value with the given rank.
+  const Fraction& get_ratio_by_rank(int rank) const { return sorted_ratios[rank]; }
+  // Returns the number of distinct ratio values < x. So for any edge counts,
+  // get_ratio(u, d) >= x iff get_rank(u, d) >= count_less(x).
+  int count_less(const Fraction& x) const;
+  // Returns the number of distinct ratio values <= x. So for any edge counts,
+  // get_ratio(u, d) <= x iff get_rank(u, d) < count_at_most(x).
+  int count_at_most(const Fraction& x) const;
+
+ private:
+  int total_edges;
+  // The ratios and their ranks, indexed by undirected * (total_edges + 1) + directed.
+  std::vector<Fraction> ratios;
+  std::vector<uint16> ranks;
+  // The distinct ratio values in increasing order.
+  std::vector<Fraction> sorted_ratios;
+
+  int index(int undirected, int directed) const {
+    assert(undirected >= 0 && directed >= 0 && undirected + directed <= total_edges);
+    return undirected * (total_edges + 1) + directed;
+  }
+};
+
 // Represents a k-PDG, with the data structure optimized for computing isomorphisms.
 // The n vertices in this graph: 0, 1, ..., n-1.
 struct Graph {
@@ -85,8 +144,16 @@ struct Graph {
   // Global to all graph instances: pre-computed the vertex masks, used in
   // various computations including compute_codegree_signature().
   static VertexMask VERTEX_MASKS[MAX_VERTICES + 1];
-
-  // Set the values of K, N, and TOTAL_EDGES.
+  // Global to all graph instances: the rank of each vertex set with exactly K vertices, namely
+  // its index in VERTEX_MASKS[K].masks. Since the masks are generated in increasing order, the
+  // rank order is the same as the numerical order of the vertex sets. Values for vertex sets
+  // that don't have exactly K vertices are unspecified.
+  static uint8 EDGE_RANKS[1 << MAX_VERTICES];
+  // Global to all graph instances: the theta_ratio and zeta_ratio values by the edge counts.
+  static RatioTable THETA_RATIOS;
+  static RatioTable ZETA_RATIOS;
+
+  // Set the values of K, N, and TOTAL_EDGES, and computes the tables above.
   static void set_global_graph_info(int k, int n);
 
   // Parses the edge representation into a Graph object. Returns true if successful.
@@ -109,9 +176,17 @@ struct Graph {
   // The edge set in this graph.
   Edge edges[MAX_EDGES];
 
-  // Information of the vertices
+  // Information of the vertices. The degrees are updated by add_edge() as edges are added.
   VertexSignature vertices[MAX_VERTICES];
 
+  // Bitmap of the edges in this graph, indexed by the edge rank (see EDGE_RANKS). This is kept
+  // in sync with the edges array, and allows checking whether a vertex set is an edge with a
+  // single bit test, instead of scanning the edges array.
+  uint64 edge_bits[2];
+  // The head vertex of each edge in the graph, 4 bits per edge indexed by the edge rank.
+  // The value is UNDIRECTED for undirected edges, and 0 for vertex sets not in the graph.
+  uint64 edge_heads[(MAX_EDGES + 15) / 16];
+
  public:
   Graph();
 
@@ -134,30 +209,42 @@ struct Graph {
   // to be added to the graph (this vertex set does not yet exist in the edges).
   bool edge_allowed(uint16 vertices) const;
 
+  // Returns true if the edge with the given rank (see EDGE_RANKS) is in the graph.
+  bool has_edge_rank(int rank) const { return ((edge_bits[rank >> 6] >> (rank & 63)) & 1) != 0; }
+  // Returns the head vertex (or UNDIRECTED) of the edge with the given rank. The edge must be
+  // in the graph.
+  uint8 get_head_rank(int rank) const {
+    return (edge_heads[rank >> 4] >> ((rank & 15) << 2)) & 0x0F;
+  }
+  // Same as above, but the edge is specified by the bitmask of the K vertices in the edge.
+  bool has_edge(uint16 vertex_set) const { return has_edge_rank(EDGE_RANKS[vertex_set]); }
+  uint8 get_head(uint16 vertex_set) const { return get_head_rank(EDGE_RANKS[vertex_set]); }
+
   // Adds an edge to the graph. It's caller's responsibility to make sure this is allowed.
   // And the input is consistent (head is inside the vertex set).
   void add_edge(Edge edge);
 
-  // Performs a permutation of the vertices according to the given p array on this graph.
-  // The first parameter specifies the permutation. For example p={1,2,0,3} means
-  //  0->1, 1->2, 2->0, 3->3.
-  // The second parameter is the resulting graph.
-  // This graph must be canonicalized, and the permutation is guaranteed to perserve that.
-  void permute_canonical(int p[], Graph& g) const;
-
-  // Canonicalizes this graph, so that the vertices are ordered by their signatures.
-  // This function also computes the graph_hash field.
+  // Canonicalizes this graph, so that the vertices are ordered by their signatures (then by their
+  // codegree info), and any two isomorphic graphs have identical canonical forms (see
+  // CanonicalLabeling for the algorithm). This function also computes the graph_hash field.
   void canonicalize();
 
-  // Copy the edge info of this graph to g. It does not copy vertex signatures and graph hash.
+  // Copy the edge info and the vertex degrees of this graph to g. It does not copy the graph hash.
   void copy_edges(Graph& g) const;
 
   // Returns true if this graph is isomorphic to the other.
   bool is_isomorphic(const Graph& other) const;
 
-  // Returns true if the two graphs are identical (exactly same edge sets).
+  // Returns true if the two graphs are identical (exactly same edge sets). The order of the edges
+  // array doesn't matter.
   bool is_identical(const Graph& other) const;
 
+  // Computes the automorphisms of this graph that map each vertex >= n to itself, other than the
+  // identity, and stores up to max_count of them in `automorphisms`: automorphisms[i][v] is the
+  // image of vertex v. All of them are found if there are at most max_count.
+  void compute_automorphisms(int n, size_t max_count,
+                             std::vector<std::array<uint8, MAX_VERTICES>>& automorphisms) const;
+
   // Print the graph to the output stream for debugging purpose.
   // If aligned==true, pad the undirected edges, so the print is easier to read.
   void print_concise(std::ostream& os, bool aligned) const;
@@ -175,12 +262,36 @@ struct Graph {
   // canonicalize() so there is no need to call this function if canonicalize() is used.
   void finalize_edges();
 
-  // Computes the vertex signatures in this graph from the edge set.
-  // The result is in the given array.
+  // Clears the edge bitmap and the edge heads.
+  void clear_edge_bits();
+  // Adds the given edge to the edge bitmap and the edge heads.
+  void set_edge_bits(Edge edge);
+  // Removes the given edge from the edge bitmap and the edge heads.
+  void unset_edge_bits(Edge edge);
+  // Adds delta (1 or -1) to the degrees of the vertices in the given edge.
+  void update_vertex_degrees(Edge edge, int delta);
+
+  // Replaces the `old_count` edges starting at edges[start] with the given new edges, keeping the
+  // order of the other edges. The edge counts, the edge bitmap and the vertex degrees are only
+  // updated for the replaced edges, so this is much cheaper than building the graph again when
+  // only a few edges change. The new edges must not be in the rest of the graph.
+  void replace_edges(int start, int old_count, const Edge new_edges[], int new_count);
+
+  // Computes the vertex signatures in this graph from scratch using the edge set. The signatures
+  // are maintained incrementally by add_edge(), replace_edges() and copy_edges(), so this is only
+  // used to verify them in debug builds.
   void compute_vertex_signature();
 
+  // Computes the codegree info of this graph: for each vertex set S with 2 <= |S| <= K-1, the
+  // number of undirected edges, directed edges with the head in S, and directed edges with the
+  // head not in S, that contain S. Returns an isomorphism invariant hash of the codegree info,
+  // and stores in vertex_codegrees[v] an invariant hash of the codegree info of all vertex sets
+  // containing v. For K=2 there is no such vertex set, and all the hashes are 0.
+  uint64 compute_codegree_signature(uint64 vertex_codegrees[MAX_VERTICES]) const;
+
   // Perform a permutation of the vertices of this graph according to the p array, put in `g`.
-  // Only set the data in the edges array in `g` without touching other fields.
+  // Only set the data in the edges array, the edge bitmap, and the vertex signatures in `g`
+  // without touching other fields.
   void permute_edges(int p[], Graph& g) const;
 
   // Returns a graph isomorphic to this graph, by applying vertex permutation.
@@ -196,32 +307,61 @@ struct Graph {
   // algorithm.
   bool is_isomorphic_slow(const Graph& other) const;
 
+  // Searches for an isomorphism from this graph to the other, by mapping the vertices one at a
+  // time with backtracking. A vertex is only mapped to a vertex with the same degrees, and a
+  // partial mapping is rejected as soon as an edge with all its vertices mapped has no image in
+  // the other graph. Neither graph needs to be canonicalized. Returns true if an isomorphism is
+  // found, which is stored in p: vertex v in this graph is mapped to p[v] in the other graph.
+  // This is used to verify the canonical forms, and unlike is_isomorphic_slow() it is fast
+  // enough for all N<=12.
+  bool find_isomorphism(const Graph& other, int p[MAX_VERTICES]) const;
+  // Same as above, but calls `found` with each isomorphism found, where the vertices >= n are
+  // only mapped to themselves, until `found` returns true. Returns true if stopped by `found`.
+  bool search_isomorphisms(const Graph& other, int n,
+                           const std::function<bool(const int p[])>& found) const;
+
   // Friend declarations for the "contains_xys" functions.
   friend bool contains_Tk(const Graph& g, int v);
   friend bool contains_K4(const Graph&, int v);
-  friend bool contains_K4D0(Graph&, int);
-  friend bool contains_K4D3(Graph&, int);
+  friend bool contains_K4D0(const Graph&, int);
+  friend bool contains_K4D3(const Graph&, int);
 
   // Friend declarations that allows unit testing of some private implementations.
 #define FRIEND_TEST(test_case_name, test_name) friend class test_case_name##_##test_name##_Test
   FRIEND_TEST(GraphTest, PermuteIsomorphic);
   FRIEND_TEST(GraphTest, PermuteCanonical);
+  FRIEND_TEST(GraphTest, PermuteCanonical2);
   FRIEND_TEST(GraphTest, Canonicalize);
   FRIEND_TEST(GraphTest, Canonicalize2);
   FRIEND_TEST(GraphTest, Canonicalize3);
+  FRIEND_TEST(GraphTest, CanonicalFormRegular);
+  FRIEND_TEST(GraphTest, CodegreeSignature);
   FRIEND_TEST(GraphTest, ContainsT3);
   FRIEND_TEST(GraphTest, Copy);
   FRIEND_TEST(GraphTest, NotContainsT3);
   FRIEND_TEST(GraphTest, IsomorphicSlow);
+  FRIEND_TEST(GraphTest, FindIsomorphism);
+  FRIEND_TEST(GraphTest, FindIsomorphismLarge);
+  FRIEND_TEST(GraphTest, Automorphisms);
+  FRIEND_TEST(GraphTest, IsomorphicNotIdentical);
   FRIEND_TEST(GraphTest, Isomorphic_B);
   FRIEND_TEST(GraphTest, Isomorphic_C);
   FRIEND_TEST(GraphTest, GraphDataStructure);
+  FRIEND_TEST(GraphTest, EdgeBitmap);
+  FRIEND_TEST(GraphTest, IncrementalVertexDegrees);
   FRIEND_TEST(GraphTest, T3);
   FRIEND_TEST(EdgeGeneratorTest, Generate22);
   FRIEND_TEST(EdgeGeneratorTest, Generate23);
   FRIEND_TEST(EdgeGeneratorTest, Generate23WithSkip);
   FRIEND_TEST(EdgeGeneratorTest, Generate33);
   FRIEND_TEST(EdgeGeneratorTest, Generate45);
+  FRIEND_TEST(EdgeGeneratorTest, IncrementalUpdate);
   friend class IsomorphismStressTest;
+  friend class GraphBenchmark;
+  // The GraphStore packs and unpacks the edge bitmap and the edge heads.
+  friend class GraphStore;
+  // The EdgeGenerator and the EdgeSearcher update the generated graphs with replace_edges().
+  friend class EdgeGenerator;
+  friend class EdgeSearcher;
 };
-static_assert(sizeof(Graph) == 196);
+static_assert(sizeof(Graph) == 256);
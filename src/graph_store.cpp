@@ -0,0 +1,152 @@
+#include "graph_store.h"
+
+#include "counters.h"
+
+GraphStore::GraphStore()
+    : bits_words((Graph::TOTAL_EDGES + 63) / 64),
+      heads_words((Graph::TOTAL_EDGES + 15) / 16),
+      words_per_graph(bits_words + heads_words) {}
+
+// Adds a canonicalized graph to the end of the store.
+void GraphStore::push_back(const Graph& g) {
+  assert(g.is_canonical);
+  words.insert(words.end(), g.edge_bits, g.edge_bits + bits_words);
+  words.insert(words.end(), g.edge_heads, g.edge_heads + heads_words);
+  hashes.push_back(g.graph_hash);
+}
+
+// Adds the i-th graph of another store to the end of this store, without unpacking.
+void GraphStore::push_back(const GraphStore& other, size_t i) {
+  assert(other.words_per_graph == words_per_graph);
+  words.insert(words.end(), other.packed(i), other.packed(i) + words_per_graph);
+  hashes.push_back(other.hashes[i]);
+}
+
+// Removes the last graph from the store.
+void GraphStore::pop_back() {
+  words.resize(words.size() - words_per_graph);
+  hashes.pop_back();
+}
+
+// Unpacks the i-th graph into g, by adding the edges in the order of their ranks, which also
+// rebuilds the vertex degrees and the sorted edges array.
+void GraphStore::get(size_t i, Graph& g) const {
+  const uint64* p = packed(i);
+  g = Graph();
+  const uint16* masks = Graph::VERTEX_MASKS[Graph::K].masks;
+  for (int w = 0; w < bits_words; w++) {
+    for (uint64 bits = p[w]; bits != 0; bits &= bits - 1) {
+      int rank = (w << 6) + __builtin_ctzll(bits);
+      uint8 head = (p[bits_words + (rank >> 4)] >> ((rank & 15) << 2)) & 0x0F;
+      g.add_edge(Edge(masks[rank], head));
+    }
+  }
+  g.graph_hash = hashes[i];
+  g.is_canonical = true;
+}
+
+// Same as above, but returns the unpacked graph.
+Graph GraphStore::operator[](size_t i) const {
+  Graph g;
+  get(i, g);
+  return g;
+}
+
+// Returns the number of edges of the i-th graph.
+int GraphStore::get_edge_count(size_t i) const {
+  int count = 0;
+  for (int w = 0; w < bits_words; w++) {
+    count += __builtin_popcountll(packed(i)[w]);
+  }
+  return count;
+}
+
+// Returns the number of undirected edges of the i-th graph.
+int GraphStore::get_undirected_edge_count(size_t i) const {
+  // Absent edges have head 0, so the undirected edges are the nibbles equal to UNDIRECTED.
+  static_assert(UNDIRECTED == 0x0F);
+  int count = 0;
+  for (int w = 0; w < heads_words; w++) {
+    uint64 x = packed(i)[bits_words + w];
+    count += __builtin_popcountll(x & (x >> 1) & (x >> 2) & (x >> 3) & 0x1111111111111111ull);
+  }
+  return count;
+}
+
+// Returns true if the i-th and the j-th graphs are isomorphic.
+bool GraphStore::is_isomorphic(size_t i, size_t j) const {
+  Counters::increment_graph_isomorphic_tests();
+  if (hashes[i] != hashes[j] || get_edge_count(i) != get_edge_count(j) ||
+      get_undirected_edge_count(i) != get_undirected_edge_count(j)) {
+    return false;
+  }
+  // Both graphs are in the canonical form, so they are isomorphic iff they are identical.
+  Counters::increment_graph_identical_tests();
+  if (std::equal(packed(i), packed(i) + words_per_graph, packed(j))) {
+    Counters::increment_graph_isomorphic_true();
+    return true;
+  }
+  Counters::increment_graph_isomorphic_hash_no();
+#if !NDEBUG
+  // Verify the canonical forms: the two graphs must not be isomorphic.
+  int p[MAX_VERTICES];
+  assert(!(*this)[i].find_isomorphism((*this)[j], p));
+#endif
+  return false;
+}
+
+// Returns true if the i-th graph is less than the j-th graph in the order of Graph::operator<,
+// which compares the edge counts, then the sorted edges lexicographically, as (vertex set, head)
+// pairs with undirected before any head.
+bool GraphStore::less(size_t i, size_t j) const {
+  int count_a = get_edge_count(i);
+  int count_b = get_edge_count(j);
+  if (count_a != count_b) return count_a < count_b;
+
+  const uint64* a = packed(i);
+  const uint64* b = packed(j);
+
+  // The edges are sorted by rank. All ranks below the smallest rank in only one of the graphs
+  // (if any) are in both graphs or in neither, so the edges before it are at the same positions.
+  int diff_rank = Graph::TOTAL_EDGES;
+  for (int w = 0; w < bits_words; w++) {
+    if (a[w] != b[w]) {
+      diff_rank = (w << 6) + __builtin_ctzll(a[w] ^ b[w]);
+      break;
+    }
+  }
+  // The first common edge with different heads, if it comes before diff_rank, decides the order.
+  for (int w = 0; w < heads_words; w++) {
+    uint64 x = a[bits_words + w] ^ b[bits_words + w];
+    if (x != 0) {
+      int shift = __builtin_ctzll(x) & ~3;
+      int rank = (w << 4) + (shift >> 2);
+      if (rank >= diff_rank) break;
+      // Map UNDIRECTED to 0 and head v to v+1, so undirected comes first.
+      int head_a = (((a[bits_words + w] >> shift) & 0x0F) + 1) & 0x0F;
+      int head_b = (((b[bits_words + w] >> shift) & 0x0F) + 1) & 0x0F;
+      return head_a < head_b;
+    }
+  }
+  if (diff_rank == Graph::TOTAL_EDGES) return false;
+  // The graph with the edge at diff_rank has a smaller vertex set at that position.
+  return ((a[diff_rank >> 6] >> (diff_rank & 63)) & 1) != 0;
+}
+
+// Sorts the graphs in the order of Graph::operator<.
+void GraphStore::sort() {
+  std::vector<uint32> order(size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](uint32 i, uint32 j) { return less(i, j); });
+
+  std::vector<uint64> sorted_words;
+  std::vector<uint32> sorted_hashes;
+  sorted_words.reserve(words.size());
+  sorted_hashes.reserve(hashes.size());
+  for (uint32 i : order) {
+    sorted_words.insert(sorted_words.end(), packed(i), packed(i) + words_per_graph);
+    sorted_hashes.push_back(hashes[i]);
+  }
+  words.swap(sorted_words);
+  hashes.swap(sorted_hashes);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "graph.h"
+
+// Stores a list of canonicalized graphs compactly, used for the graphs collected in the growth
+// phase, where each level can have millions of graphs.
+//
+// Each graph is packed into the words of its edge bitmap followed by the words of its edge heads,
+// keeping only the words needed for TOTAL_EDGES edges, and its graph hash is kept in a separate
+// array. Everything else in the Graph struct can be derived from these: e.g. for K=4, N=7
+// (35 edges) a graph takes 1 + 3 words plus the hash, 36 bytes instead of sizeof(Graph)=256.
+// All graphs use the same number of words, so the i-th graph starts at word i*words_per_graph,
+// without any offset index.
+//
+// Since the graphs are canonicalized, the packed words of two isomorphic graphs are identical,
+// so they can be compared and sorted without unpacking.
+class GraphStore {
+ public:
+  // Creates an empty store, for graphs with the current global graph info (see
+  // Graph::set_global_graph_info()).
+  GraphStore();
+
+  // Returns the number of graphs in the store.
+  size_t size() const { return hashes.size(); }
+
+  // Returns the number of bytes used by the graphs in the store.
+  size_t memory_bytes() const {
+    return words.size() * sizeof(uint64) + hashes.size() * sizeof(uint32);
+  }
+
+  // Adds a canonicalized graph to the end of the store.
+  void push_back(const Graph& g);
+  // Adds the i-th graph of another store to the end of this store, without unpacking.
+  void push_back(const GraphStore& other, size_t i);
+  // Removes the last graph from the store.
+  void pop_back();
+
+  // Unpacks the i-th graph into g. The result has the same edges (in the same order), vertex
+  // degrees and graph hash as the graph that was added.
+  void get(size_t i, Graph& g) const;
+  // Same as above, but returns the unpacked graph.
+  Graph operator[](size_t i) const;
+
+  // Returns the hash of the i-th graph.
+  uint32 get_graph_hash(size_t i) const { return hashes[i]; }
+  // Returns the number of edges, and the number of undirected edges, of the i-th graph.
+  int get_edge_count(size_t i) const;
+  int get_undirected_edge_count(size_t i) const;
+
+  // Returns true if the i-th and the j-th graphs are isomorphic. This is the same as
+  // Graph::is_isomorphic() on the unpacked graphs (including the counters), but compares the
+  // packed words directly.
+  bool is_isomorphic(size_t i, size_t j) const;
+
+  // Sorts the graphs in the order of Graph::operator<, by comparing the packed words.
+  void sort();
+
+ private:
+  // Number of words of the edge bitmap and the edge heads of each graph. These are not const so
+  // that stores can be assigned.
+  int bits_words;
+  int heads_words;
+  int words_per_graph;
+  // The packed graphs.
+  std::vector<uint64> words;
+  // The graph hashes.
+  std::vector<uint32> hashes;
+
+  // Returns a pointer to the packed words of the i-th graph.
+  const uint64* packed(size_t i) const { return words.data() + i * words_per_graph; }
+
+  // Returns true if the i-th graph is less than the j-th graph in the order of Graph::operator<.
+  bool less(size_t i, size_t j) const;
+};
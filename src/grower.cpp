@@ -3,12 +3,16 @@
 #include "counters.h"
 #include "fraction.h"
 
-// Custom hash and compare for the Graph type. Treat isomorphic graphs as being equal.
-struct GraphHasher {
-  size_t operator()(const Graph& g) const { return g.get_graph_hash(); }
+// Custom hash and compare for the graphs in a GraphStore, referred to by their indices.
+// Treat isomorphic graphs as being equal. Since the graphs are canonicalized, is_isomorphic()
+// only checks whether they are identical.
+struct GraphStoreHasher {
+  const GraphStore& store;
+  size_t operator()(uint32 i) const { return store.get_graph_hash(i); }
 };
-struct GraphComparer {
-  bool operator()(const Graph& g, const Graph& h) const { return g.is_isomorphic(h); }
+struct GraphStoreComparer {
+  const GraphStore& store;
+  bool operator()(uint32 i, uint32 j) const { return store.is_isomorphic(i, j); }
 };
 
 Grower::Grower(int num_worker_threads_, bool skip_final_enum_, bool use_min_theta_opt_,
@@ -25,7 +29,12 @@ Grower::Grower(int num_worker_threads_, bool skip_final_enum_, bool use_min_thet
       log(nullptr),
       log_detail(nullptr),
       log_result(nullptr),
-      to_be_processed_id(start_idx_) {}
+      final_base_graphs(nullptr),
+      to_be_processed_end(0),
+      to_be_processed_id(start_idx_),
+      busy_threads(0),
+      idle_threads(0),
+      split_requested(false) {}
 
 void Grower::set_logging(std::ostream* summary, std::ostream* detail, std::ostream* result) {
   log = summary;
@@ -43,7 +52,7 @@ void Grower::grow() {
   assert(Graph::N <= MAX_VERTICES);
 
   // Initialize empty graph with k-1 vertices.
-  std::vector<Graph> collected_graphs[MAX_VERTICES];
+  GraphStore collected_graphs[MAX_VERTICES];
   Graph g;
   g.canonicalize();
   collected_graphs[Graph::K - 1].push_back(g);
@@ -81,64 +90,170 @@ void Grower::grow() {
   }
 }
 
+// By default, only the subgraphs with the edges that changed since the last graph without a
+// forbidden subgraph are checked.
+bool Grower::contains_forbidden_subgraph_generated(Graph& g, int v,
+                                                   EdgeGenerator& edge_gen) const {
+  Edge new_edges[MAX_EDGES];
+  int count = edge_gen.get_new_edges_since_tk_free(new_edges);
+  return contains_forbidden_subgraph_with_edges(g, v, new_edges, count);
+}
+
+// By default, the graph of the candidates is generated and checked as a whole.
+bool Grower::contains_forbidden_subgraph_in_candidates(int v, EdgeGenerator& edge_gen,
+                                                       uint64 candidate_mask) const {
+  Graph g;
+  edge_gen.generate_graph_in_candidates(g, candidate_mask);
+  return contains_forbidden_subgraph(g, v);
+}
+
+// Returns true if g, the graph just generated by edge_gen, contains a forbidden subgraph which
+// has v as a vertex. With the contains T_k optimization, the subclass can use the state of
+// edge_gen for the check.
+bool Grower::check_forbidden_subgraph(Graph& g, int v, EdgeGenerator& edge_gen) const {
+  bool result;
+  if (use_contains_Tk_opt) {
+    result = contains_forbidden_subgraph_generated(g, v, edge_gen);
+  } else {
+    result = contains_forbidden_subgraph(g, v);
+  }
+  if (!result) edge_gen.notify_tk_free();
+  return result;
+}
+
+// The new graphs of a growth step whose graph hashes are in one shard (see grow_step()), and
+// their indices to find whether a graph is isomorphic to one already collected in the shard.
+// The threads lock `mutex` to use the shard.
+struct GrowthShard {
+  // The number of shards. The shard of a graph only depends on its hash, not the thread count.
+  static constexpr uint32 COUNT = 64;
+
+  GraphStore graphs;
+  std::unordered_set<uint32, GraphStoreHasher, GraphStoreComparer> indices;
+  std::mutex mutex;
+
+  GrowthShard() : indices(0, GraphStoreHasher{graphs}, GraphStoreComparer{graphs}) {}
+
+  // Adds the last graph in `graphs` to the indices. If it's isomorphic to one already collected,
+  // removes it and returns false.
+  bool insert_last() {
+    if (indices.insert(graphs.size() - 1).second) return true;
+    graphs.pop_back();
+    return false;
+  }
+};
+
 // Constructs all non-isomorphic graphs with n vertices that are T_k-free,
 // and add them to the canonicals. Before calling this, all such graphs
 // with <n vertices must already be in the canonicals.
 // Note all edges added in this step contains vertex (n-1).
-std::vector<Graph> Grower::grow_step(int n, const std::vector<Graph>& base_graphs) {
+GraphStore Grower::grow_step(int n, const GraphStore& base_graphs) {
   assert(n < Graph::N);
-  EdgeCandidates edge_candidates(n);
   Counters::new_growth_step(n, base_graphs.size());
-  std::unordered_set<Graph, GraphHasher, GraphComparer> results;
+  // The new graphs are collected in the shards by their hashes, so the threads only lock the
+  // shard of each new graph. They are merged and sorted in the end, so the result doesn't depend
+  // on the number of threads or the order the graphs are found.
+  std::vector<std::unique_ptr<GrowthShard>> shards;
+  for (uint32 i = 0; i < GrowthShard::COUNT; i++) {
+    shards.push_back(std::make_unique<GrowthShard>());
+  }
 
   // Add all non-empty graphs from the previous step to the results.
-  for (const Graph& g : base_graphs) {
-    if (g.get_edge_count() > 0) {
-      results.insert(g);
+  for (size_t i = 0; i < base_graphs.size(); i++) {
+    if (base_graphs.get_edge_count(i) > 0) {
+      GrowthShard& shard = *shards[base_graphs.get_graph_hash(i) % GrowthShard::COUNT];
+      shard.graphs.push_back(base_graphs, i);
+      shard.insert_last();
     }
   }
 
-  // This data structure will be reused when processing the graphs.
-  Graph copy;
-
-  for (const Graph& g : base_graphs) {
-    Counters::increment_growth_processed_graphs_in_current_step();
-    EdgeGenerator edge_gen(edge_candidates, g);
-
-    // Loop through all ((K+1)^\binom{n-1}{k-1} - 1) edge combinations, add them to g, and check
-    // add to canonicals unless it's isomorphic to an existing one.
-    while (edge_gen.next(copy)) {
-      if (contains_forbidden_subgraph(copy, n - 1)) {
-        edge_gen.notify_contain_tk_skip();
-        continue;
+  // The index of the next base graph to be processed, protected by queue_mutex.
+  size_t next_base_graph = 0;
+  auto grow_thread_main = [&]() {
+    // These data structures will be reused when processing the graphs.
+    Graph g;
+    Graph copy;
+
+    while (true) {
+      size_t i;
+      {
+        std::scoped_lock lock(queue_mutex);
+        if (next_base_graph >= base_graphs.size()) return;
+        i = next_base_graph++;
+        Counters::increment_growth_processed_graphs_in_current_step();
       }
+      base_graphs.get(i, g);
+      const EdgeCandidates edge_candidates(n, g, candidate_order);
+      EdgeGenerator edge_gen(edge_candidates, g);
+      const EdgeGenerator::CandidatesContainFunction contains_in_candidates =
+          [&](uint64 candidate_mask) {
+            return contains_forbidden_subgraph_in_candidates(n - 1, edge_gen, candidate_mask);
+          };
+
+      // Loop through all ((K+1)^\binom{n-1}{k-1} - 1) edge combinations, add them to g, and
+      // check add to canonicals unless it's isomorphic to an existing one.
+      while (edge_gen.next(copy)) {
+        if (check_forbidden_subgraph(copy, n - 1, edge_gen)) {
+          edge_gen.notify_contain_tk_skip(contains_in_candidates);
+          continue;
+        }
 
-      copy.canonicalize();
+        copy.canonicalize();
 
-      if (results.find(copy) == results.cend()) {
-        results.insert(copy);
-        Counters::observe_ratio(copy, get_ratio(copy));
+        // Add the graph to its shard tentatively, and remove it if it's isomorphic to an
+        // existing one.
+        GrowthShard& shard = *shards[copy.get_graph_hash() % GrowthShard::COUNT];
+        bool added;
+        {
+          std::scoped_lock lock(shard.mutex);
+          shard.graphs.push_back(copy);
+          added = shard.insert_last();
+        }
+        if (added) {
+          std::scoped_lock lock(counters_mutex);
+          Counters::observe_ratio(copy, get_ratio(copy));
+        }
       }
     }
+  };
+
+  if (num_worker_threads == 0) {
+    grow_thread_main();
+  } else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_worker_threads; i++) {
+      threads.push_back(std::thread(grow_thread_main));
+    }
+    for (std::thread& t : threads) {
+      t.join();
+    }
   }
 
-  std::vector<Graph> new_graphs(results.cbegin(), results.cend());
-  std::sort(new_graphs.begin(), new_graphs.end());
+  // Merge the shards, releasing each one after it's copied.
+  GraphStore new_graphs;
+  for (std::unique_ptr<GrowthShard>& shard : shards) {
+    for (size_t i = 0; i < shard->graphs.size(); i++) {
+      new_graphs.push_back(shard->graphs, i);
+    }
+    shard.reset();
+  }
+  new_graphs.sort();
   return new_graphs;
 }
 
-void Grower::enumerate_final_step(const std::vector<Graph>& base_graphs) {
+void Grower::enumerate_final_step(const GraphStore& base_graphs) {
   int max_idx = static_cast<int>(base_graphs.size());
   if (end_idx > 0 && end_idx < max_idx) {
     max_idx = end_idx + 1;
   }
-  for (int i = start_idx; i < max_idx; i++) {
-    to_be_processed.push(base_graphs[i]);
-  }
-  Counters::enter_final_step(to_be_processed.size());
+  final_base_graphs = &base_graphs;
+  to_be_processed_end = max_idx;
+  Counters::enter_final_step(std::max(0, max_idx - start_idx));
   if (search_ratio_graph) {
     Counters::initialize_ratio_graph_search(ratio_to_search);
   }
+  busy_threads = std::max(1, num_worker_threads);
+  idle_threads = 0;
 
   if (num_worker_threads == 0) {
     worker_thread_main(0);
@@ -164,73 +279,52 @@ void Grower::worker_thread_main(int thread_id) {
   int base_graph_id;
   Graph copy;
   Graph min_ratio_graph;
-  EdgeCandidates edge_candidates(Graph::N);
+  // The ratios of the new graphs are compared by their ranks in the ratio table. A ratio is
+  // <= ratio_to_search iff its rank is < search_rank_end.
+  const RatioTable& ratio_table = get_ratio_table();
+  const int search_rank_end = ratio_table.count_at_most(ratio_to_search);
+  // The bound of the ratio for the min ratio optimization, or null if it's not used.
+  const RatioBound* bound = get_ratio_bound();
+  assert(bound == nullptr || &bound->get_ratio_table() == &ratio_table);
 
   auto last_check_time = std::chrono::steady_clock::now();
-
-  while (true) {
-    // The lock scope to safely get a graph from the queue.
-    {
-      std::scoped_lock lock(queue_mutex);
-      if (to_be_processed.empty()) return;
-      base = to_be_processed.front();
-      base_graph_id = to_be_processed_id++;
-      to_be_processed.pop();
-      Counters::increment_growth_processed_graphs_in_current_step();
-    }
-
-    Fraction min_ratio = Fraction::infinity();
-    if (search_ratio_graph) {
-      // If we are searching all graphs generating the given ratio value, set min_ratio
-      // to be slightly higher than the given value so that the min_ratio optimization
-      // won't skip any graph that produces the ratio value.
-      min_ratio = ratio_to_search + Fraction::epsilon();
-    }
+  // The results of the base graphs finished by this thread, and the smallest ratio it added to
+  // the Counters.
+  std::vector<std::tuple<int, Graph, Graph>> thread_results;
+  Fraction observed_min_ratio = Fraction::infinity();
+
+  BaseGraphChunk chunk;
+  FinalTask task;
+  while (take_final_task(chunk, task)) {
+    base_graph_id = task.base_graph_id;
+    // The store is not modified in this step, so the graph can be unpacked outside of the lock.
+    final_base_graphs->get(base_graph_id, base);
+    const EdgeCandidates edge_candidates(Graph::N, base, candidate_order);
+
+    Fraction min_ratio = task.min_ratio;
+    // A ratio is < min_ratio iff its rank is < min_ratio_rank.
+    int min_ratio_rank = ratio_table.count_less(min_ratio);
+    // Whether min_ratio_graph is found in this task.
+    bool found = false;
 
     uint64 graphs_processed = 0;
-    EdgeGenerator edge_gen(edge_candidates, base);
-    while (edge_gen.next(copy, true, min_ratio)) {
-      // Thread 0 has the extra responsibility as time keeper,
-      // to periodically ask Counters to print.
-      if (thread_id == 0) {
-        if (edge_gen.stats_edge_sets % stats_check_every_n_gen == 0) {
-          const auto now = std::chrono::steady_clock::now();
-          int seconds =
-              std::chrono::duration_cast<std::chrono::seconds>(now - last_check_time).count();
-          if (seconds >= stats_print_every_n_seconds) {
-            std::scoped_lock lock(counters_mutex);
-            last_check_time = now;
-            Counters::observe_ratio(min_ratio_graph, get_ratio(min_ratio_graph), graphs_processed);
-            Counters::observe_edgegen_stats(edge_gen.stats_tk_skip, edge_gen.stats_tk_skip_bits,
-                                            edge_gen.stats_theta_edges_skip,
-                                            edge_gen.stats_theta_directed_edges_skip,
-                                            edge_gen.stats_edge_sets);
-            edge_gen.clear_stats();
-            Counters::print_at_time_interval();
-            if (log != nullptr) {
-              edge_gen.print_debug(std::cout, false, base_graph_id);
-              edge_gen.print_debug(*log, false, base_graph_id);
-            }
-          }
-        }
-      }
-
-      if (contains_forbidden_subgraph(copy, Graph::N - 1)) {
-        edge_gen.notify_contain_tk_skip();
-        continue;
-      }
-
-      // Bookkeeping: retain the minimum ratio value encountered so far, and the graph genreated it.
+    // Bookkeeping of each new graph without a forbidden subgraph: retain the minimum ratio value
+    // encountered so far, and the graph genreated it. Returns the (new) min_ratio.
+    auto process_graph = [&](const Graph& copy) {
       graphs_processed++;
+      int rank =
+          ratio_table.get_rank(copy.get_undirected_edge_count(), copy.get_directed_edge_count());
       if (!search_ratio_graph) {
         // Normal path: we are searching for min_ratio.
-        if (get_ratio(copy) < min_ratio) {
-          min_ratio = get_ratio(copy);
+        if (rank < min_ratio_rank) {
+          min_ratio_rank = rank;
+          min_ratio = ratio_table.get_ratio_by_rank(rank);
           min_ratio_graph = copy;
+          found = true;
         }
       } else {
         // Here we are searching for all graphs that produce the given ratio value.
-        if (get_ratio(copy) <= ratio_to_search) {
+        if (rank < search_rank_end) {
           std::string to_print = "G[" + std::to_string(base_graph_id) +
                                  "], base_ratio = " + get_ratio(base).to_string() +
                                  ", grow_to_ratio = " + get_ratio(copy).to_string() + " :\n  " +
@@ -244,48 +338,296 @@ void Grower::worker_thread_main(int thread_id) {
           Counters::notify_ratio_graph_found(copy, get_ratio(copy));
         }
       }
+      return min_ratio;
+    };
+
+    // Thread 0 has the extra responsibility as time keeper, to periodically ask Counters to
+    // print. `gen` is the EdgeGenerator or the EdgeSearcher of the base graph.
+    auto keep_time = [&](auto& gen) {
+      const auto now = std::chrono::steady_clock::now();
+      int seconds =
+          std::chrono::duration_cast<std::chrono::seconds>(now - last_check_time).count();
+      if (seconds >= stats_print_every_n_seconds) {
+        std::scoped_lock lock(counters_mutex);
+        last_check_time = now;
+        Counters::observe_ratio(min_ratio_graph, get_ratio(min_ratio_graph), graphs_processed);
+        observe_edge_stats(gen);
+        Counters::print_at_time_interval();
+        if (log != nullptr) {
+          gen.print_debug(std::cout, false, base_graph_id);
+          gen.print_debug(*log, false, base_graph_id);
+        }
+      }
+    };
+
+    EdgeGenerator edge_gen(edge_candidates, base);
+    EdgeSearcher edge_searcher(edge_candidates, base);
+    SkeletonSearcher skeleton_searcher(edge_candidates, base);
+    edge_gen.set_ratio_bound(bound);
+    edge_searcher.set_ratio_bound(bound);
+    const EdgeGenerator::CandidatesContainFunction contains_in_candidates =
+        [&](uint64 candidate_mask) {
+          return contains_forbidden_subgraph_in_candidates(Graph::N - 1, edge_gen, candidate_mask);
+        };
+    // The orientation solver of the base graph, if the skeleton search is used.
+    std::unique_ptr<OrientationSolver> solver;
+    if (use_skeleton_search && !search_ratio_graph) {
+      solver = create_orientation_solver(edge_candidates, base);
+    }
+    // The automorphisms of the base graph, computed once for both the generator and the searcher.
+    std::unique_ptr<CandidateSymmetry> symmetry;
+    if (use_symmetry_breaking && !search_ratio_graph && solver == nullptr) {
+      symmetry = std::make_unique<CandidateSymmetry>(edge_candidates, base);
+      edge_gen.set_symmetry(symmetry.get());
+      edge_searcher.set_symmetry(symmetry.get());
+    }
+    auto progress = [&]() {
+      if (thread_id == 0 && skeleton_searcher.stats_skeletons % stats_check_every_n_gen == 0) {
+        keep_time(skeleton_searcher);
+      }
+    };
+    // The graphs from the orientation solver or the target search are only processed once, and
+    // they are verified in debug builds.
+    auto verify_and_process = [&](const Graph& g) {
+#if !NDEBUG
+      Graph check = g;
+      assert(!contains_forbidden_subgraph(check, Graph::N - 1));
+#endif
+      return process_graph(g);
+    };
+    // The edges are checked when placed by the edge searcher, where the graph without the edge is
+    // known to be free of the forbidden subgraphs, so only the subgraphs with the new edge are
+    // checked.
+    auto contains = [&](Graph& g, const Edge& edge) {
+      if (thread_id == 0 && edge_searcher.stats_edges_placed % stats_check_every_n_gen == 0) {
+        keep_time(edge_searcher);
+      }
+      return contains_forbidden_subgraph_with_edges(g, Graph::N - 1, &edge, 1);
+    };
+
+    if (use_target_search && !search_ratio_graph) {
+      // Try the targets in increasing order of the ratio, and among the same ratio, with fewer
+      // new edges first. Only the ratios < min_ratio are tried, so the search finds nothing if
+      // every graph has an infinite ratio, the same as the other searches.
+      std::vector<std::tuple<int, int, int>> targets;
+      for (int u = 0; u <= edge_candidates.edge_candidate_count; u++) {
+        for (int d = 0; u + d <= edge_candidates.edge_candidate_count; d++) {
+          const int rank = ratio_table.get_rank(base.get_undirected_edge_count() + u,
+                                                base.get_directed_edge_count() + d);
+          if (u + d > 0 && rank < min_ratio_rank) targets.push_back({rank, u + d, u});
+        }
+      }
+      std::sort(targets.begin(), targets.end());
+      for (const auto& [rank, count, u] : targets) {
+        if (solver != nullptr
+                ? skeleton_searcher.search_target(copy, *solver, u, count - u, progress)
+                : edge_searcher.search_target(copy, u, count - u, contains)) {
+          assert(copy.get_undirected_edge_count() == base.get_undirected_edge_count() + u);
+          verify_and_process(copy);
+          break;
+        }
+      }
+    } else if (solver != nullptr) {
+      skeleton_searcher.search(copy, *solver, min_ratio, verify_and_process, progress);
+    } else if (!use_edge_searcher) {
+      edge_gen.set_range(task.range);
+      bool can_split = true;
+      while (edge_gen.next(copy, bound != nullptr, min_ratio)) {
+        if (thread_id == 0 && edge_gen.stats_edge_sets % stats_check_every_n_gen == 0) {
+          keep_time(edge_gen);
+        }
+        if (can_split && split_requested.load(std::memory_order_relaxed)) {
+          can_split = split_final_task(task, edge_gen, min_ratio);
+        }
+
+        if (check_forbidden_subgraph(copy, Graph::N - 1, edge_gen)) {
+          edge_gen.notify_contain_tk_skip(contains_in_candidates);
+          continue;
+        }
+        process_graph(copy);
+      }
+    } else {
+      edge_searcher.search(copy, min_ratio, contains, process_graph);
     }
 
-    // The lock scope to add the min ratio to the global Counters.
-    {
+    // Add the stats to the global Counters. Only a smaller min ratio than the thread has already
+    // added needs the lock, and the time keeper's check whether to print.
+    Counters::observe_graphs_processed(graphs_processed);
+    if (solver != nullptr) {
+      observe_edge_stats(skeleton_searcher);
+    } else if (use_edge_searcher || (use_target_search && !search_ratio_graph)) {
+      observe_edge_stats(edge_searcher);
+    } else {
+      observe_edge_stats(edge_gen);
+    }
+    const Fraction ratio = get_ratio(min_ratio_graph);
+    if (ratio < observed_min_ratio) {
       std::scoped_lock lock(counters_mutex);
-      results.push_back(std::make_tuple(base_graph_id, base, min_ratio_graph));
-      Counters::observe_ratio(min_ratio_graph, get_ratio(min_ratio_graph), graphs_processed);
-      Counters::observe_edgegen_stats(
-          edge_gen.stats_tk_skip, edge_gen.stats_tk_skip_bits, edge_gen.stats_theta_edges_skip,
-          edge_gen.stats_theta_directed_edges_skip, edge_gen.stats_edge_sets);
-      if (log_detail != nullptr && !search_ratio_graph) {
-        *log_detail << "---- G[" << base_graph_id << "] T[" << thread_id
-                    << "]: min_ratio = " << min_ratio.to_string() << " :\n  ";
-        base.print_concise(*log_detail, true);
-        *log_detail << "  ";
-        min_ratio_graph.print_concise(*log_detail, true);
-        log_detail->flush();
-      }
+      observed_min_ratio = ratio;
+      Counters::observe_ratio(min_ratio_graph, ratio, 0);
+    } else if (thread_id == 0) {
+      std::scoped_lock lock(counters_mutex);
+      Counters::print_at_time_interval();
+    }
+    // The result of a split base graph is reported by the thread finishing its last task.
+    Graph result_graph = min_ratio_graph;
+    if (task.is_split && !finish_split_task(base_graph_id, found, min_ratio, result_graph)) {
+      continue;
+    }
+    thread_results.push_back(std::make_tuple(base_graph_id, base, result_graph));
+    if (log_detail != nullptr && !search_ratio_graph) {
+      std::scoped_lock lock(counters_mutex);
+      *log_detail << "---- G[" << base_graph_id << "] T[" << thread_id
+                  << "]: min_ratio = " << min_ratio.to_string() << " :\n  ";
+      base.print_concise(*log_detail, true);
+      *log_detail << "  ";
+      result_graph.print_concise(*log_detail, true);
+      log_detail->flush();
+    }
+  }
+
+  std::scoped_lock lock(counters_mutex);
+  results.insert(results.end(), thread_results.begin(), thread_results.end());
+}
+
+bool Grower::take_final_task(BaseGraphChunk& chunk, FinalTask& task) {
+  if (chunk.next == chunk.end) {
+    // Claim the next chunk of ids. The chunks get smaller towards the end of the range, so the
+    // last base graphs are spread among the threads, while the cheap base graphs before them
+    // don't need an atomic update each.
+    const int threads = std::max(1, num_worker_threads);
+    int begin = to_be_processed_id.load();
+    int size = 0;
+    while (begin < to_be_processed_end) {
+      size = std::clamp((to_be_processed_end - begin) / (4 * threads), 1, MAX_CHUNK_SIZE);
+      if (to_be_processed_id.compare_exchange_weak(begin, begin + size)) break;
+      size = 0;
+    }
+    chunk.next = begin;
+    chunk.end = begin + size;
+  }
+  if (chunk.next < chunk.end) {
+    task = FinalTask();
+    task.base_graph_id = chunk.next++;
+    if (search_ratio_graph) {
+      // If we are searching all graphs generating the given ratio value, set min_ratio
+      // to be slightly higher than the given value so that the min_ratio optimization
+      // won't skip any graph that produces the ratio value.
+      task.min_ratio = ratio_to_search + Fraction::epsilon();
+    }
+    Counters::increment_growth_processed_graphs_in_current_step();
+    return true;
+  }
+
+  // All base graphs are taken, the thread is no longer busy unless it takes a split off task.
+  std::unique_lock lock(queue_mutex);
+  --busy_threads;
+  while (split_tasks.empty()) {
+    if (busy_threads == 0) {
+      // All tasks are finished. Wake up the other idle threads to return as well.
+      split_requested = false;
+      task_available.notify_all();
+      return false;
     }
+    // Ask the busy threads to split their tasks, and wait.
+    ++idle_threads;
+    split_requested = true;
+    task_available.wait(lock);
+    --idle_threads;
+  }
+  task = split_tasks.front();
+  split_tasks.pop_front();
+  ++busy_threads;
+  return true;
+}
+
+bool Grower::split_final_task(FinalTask& task, EdgeGenerator& edge_gen, Fraction min_ratio) {
+  std::scoped_lock lock(queue_mutex);
+  // Another thread already split its task for the idle threads.
+  if (idle_threads == 0 || !split_tasks.empty()) return true;
+  std::vector<EdgeSetRange> ranges;
+  if (edge_gen.split_range(MIN_SPLIT_FREE_COUNT, ranges) == 0) return false;
+  for (const EdgeSetRange& range : ranges) {
+    split_tasks.push_back(FinalTask{task.base_graph_id, range, min_ratio, true});
+  }
+  // The entry is added by the first split of the base graph, with this task unfinished.
+  base_results[task.base_graph_id].unfinished_tasks += ranges.size();
+  task.is_split = true;
+  Counters::observe_final_split_tasks(ranges.size());
+  split_requested = false;
+  task_available.notify_all();
+  return true;
+}
+
+bool Grower::finish_split_task(int base_graph_id, bool found, Fraction& min_ratio,
+                               Graph& min_ratio_graph) {
+  std::scoped_lock lock(queue_mutex);
+  FinalBaseResult& result = base_results[base_graph_id];
+  // The first finished task gives the result if no task finds a graph, the same as without
+  // splitting.
+  if (!result.has_result || (found && (!result.found || min_ratio < result.min_ratio))) {
+    result.has_result = true;
+    result.found = found;
+    result.min_ratio = min_ratio;
+    result.min_ratio_graph = min_ratio_graph;
   }
+  if (--result.unfinished_tasks > 0) return false;
+  min_ratio = result.min_ratio;
+  min_ratio_graph = result.min_ratio_graph;
+  base_results.erase(base_graph_id);
+  return true;
+}
+
+// Adds the stats of the generator to the Counters, and clears them.
+void Grower::observe_edge_stats(EdgeGenerator& edge_gen) {
+  Counters::observe_edgegen_stats(
+      edge_gen.stats_tk_skip, edge_gen.stats_tk_skip_bits, edge_gen.stats_tk_conflict_skip,
+      edge_gen.stats_tk_conflict_skip_bits, edge_gen.stats_theta_edges_skip,
+      edge_gen.stats_theta_directed_edges_skip, edge_gen.stats_symmetry_skip,
+      edge_gen.stats_edge_sets);
+  edge_gen.clear_stats();
+}
+
+// Same as above, for the searcher. The pruned subtrees are reported as the skips of the
+// generator.
+void Grower::observe_edge_stats(EdgeSearcher& edge_searcher) {
+  Counters::observe_edgegen_stats(edge_searcher.stats_forbidden_prunes, 0, 0, 0,
+                                  edge_searcher.stats_theta_prunes, 0,
+                                  edge_searcher.stats_symmetry_prunes,
+                                  edge_searcher.stats_edge_sets);
+  edge_searcher.clear_stats();
+}
+
+// Same as above, for the skeleton searcher, where the skeletons are reported as the edge sets.
+void Grower::observe_edge_stats(SkeletonSearcher& skeleton_searcher) {
+  Counters::observe_edgegen_stats(skeleton_searcher.stats_forbidden_prunes, 0, 0, 0,
+                                  skeleton_searcher.stats_theta_prunes, 0, 0,
+                                  skeleton_searcher.stats_skeletons);
+  skeleton_searcher.clear_stats();
 }
 
 // Print the content of the collected graphs after the growth to console and log files.
-void Grower::print_before_final(const std::vector<Graph> collected_graphs[MAX_VERTICES]) const {
+void Grower::print_before_final(const GraphStore collected_graphs[MAX_VERTICES]) const {
   if (log != nullptr) {
     print_state_to_stream(std::cout, collected_graphs);
     print_state_to_stream(*log, collected_graphs);
     log->flush();
   }
   if (log_detail != nullptr) {
+    Graph g;
     for (int i = 0; i < Graph::N; i++) {
       Fraction min_ratio = Fraction::infinity();
-      for (const Graph& g : collected_graphs[i]) {
+      for (size_t j = 0; j < collected_graphs[i].size(); j++) {
+        collected_graphs[i].get(j, g);
         min_ratio = std::min(min_ratio, get_ratio(g));
       }
 
       *log_detail << "-------- Accumulated canonicals[order=" << i
                   << "] : count = " << collected_graphs[i].size()
                   << ", min_ratio = " << min_ratio.to_string() << " --------\n";
-      int idx = 0;
-      for (const Graph& g : collected_graphs[i]) {
-        *log_detail << "  [" << idx++ << "] ";
+      for (size_t j = 0; j < collected_graphs[i].size(); j++) {
+        collected_graphs[i].get(j, g);
+        *log_detail << "  [" << j << "] ";
         g.print_concise(*log_detail, true);
       }
     }
@@ -293,18 +635,21 @@ void Grower::print_before_final(const std::vector<Graph> collected_graphs[MAX_VE
   }
 }
 void Grower::print_state_to_stream(std::ostream& os,
-                                   const std::vector<Graph> collected_graphs[MAX_VERTICES]) const {
+                                   const GraphStore collected_graphs[MAX_VERTICES]) const {
   os << "\n---------------------------------\n"
      << "Growth phase completed. State:\n";
+  Graph g;
   for (int i = 0; i < Graph::N; i++) {
     int all_directed = 0;
-    for (const Graph& g : collected_graphs[i]) {
+    for (size_t j = 0; j < collected_graphs[i].size(); j++) {
+      collected_graphs[i].get(j, g);
       if (g.get_directed_edge_count() == g.get_edge_count()) {
         ++all_directed;
       }
     }
     os << "    order=" << i << " : collected= " << collected_graphs[i].size()
-       << ", all_edge_directed= " << all_directed << "\n";
+       << ", all_edge_directed= " << all_directed
+       << ", memory_bytes= " << collected_graphs[i].memory_bytes() << "\n";
   }
   os << "---------------------------------\n\nStarting final enumeration phase...\n";
 }
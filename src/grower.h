@@ -2,11 +2,13 @@
 
 #include "edge_gen.h"
 #include "graph.h"
+#include "graph_store.h"
 
 // Grow set of non-isomorphic graphs from empty graph, by adding one vertex at a time.
 class Grower {
  private:
-  // The number of worker threads to use in the final enumeration step.
+  // The number of worker threads to use in the growth steps and the final enumeration step. If
+  // it's 0, the calling thread does all the work.
   const int num_worker_threads;
   // If true, stop after the growing phase but don't perform the final enumeration phase.
   const bool skip_final_enum;
@@ -23,6 +25,32 @@ class Grower {
   // The ratio value to search for. Ignored unless search_ratio_graph==true.
   const Fraction ratio_to_search;
 
+  // If true, the final enumeration phase uses the depth-first EdgeSearcher instead of the
+  // EdgeGenerator odometer. The searcher always uses both optimizations, and checks the
+  // forbidden subgraphs with contains_forbidden_subgraph_with_edges().
+  bool use_edge_searcher = false;
+
+  // If true, and the subclass supports it with create_orientation_solver(), the final
+  // enumeration phase uses the SkeletonSearcher instead of the above. Ignored in the ratio-graph
+  // search, which needs all orientations of the skeletons, not only the best one.
+  bool use_skeleton_search = false;
+
+  // If true, the final enumeration phase decides for each base graph whether the numbers of new
+  // undirected and directed edges can be reached without a forbidden subgraph, in increasing
+  // order of their ratios, and stops at the first one that can. The decisions are made by the
+  // SkeletonSearcher if it's used, otherwise by the EdgeSearcher. Ignored in the ratio-graph
+  // search.
+  bool use_target_search = false;
+
+  // If true, the final enumeration phase skips the edge sets that an automorphism of the base
+  // graph maps to an earlier edge set (see CandidateSymmetry). Ignored in the ratio-graph search,
+  // which reports all graphs with the ratio, including the isomorphic ones.
+  bool use_symmetry_breaking = false;
+
+  // The order of the edge candidates of each base graph, in the growth steps and the final
+  // enumeration phase.
+  CandidateOrder candidate_order = CandidateOrder::NATURAL;
+
   // The number of generations between checking whether should print statistics.
   uint64 stats_check_every_n_gen = 100000;
   // The number of seconds between printing statistics in the final enumeration step.
@@ -38,49 +66,175 @@ class Grower {
   // The second parameter is the collection of graphs collected from the previous step
   // with (n-1) vertices.
   //
-  // This function is called repeatedly to grow all graphs up to N-1 vertices.
-  std::vector<Graph> grow_step(int n, const std::vector<Graph>&);
+  // This function is called repeatedly to grow all graphs up to N-1 vertices. The base graphs
+  // are processed by num_worker_threads threads, and the result is the same for any number of
+  // threads.
+  GraphStore grow_step(int n, const GraphStore&);
 
   // Enumerates all graphs in the final step where all graphs have N vertices.
   // We don't need to collect any graph in this step.
   // The parameter is the collection of graphs collected from the last grow_step()
   // with (N-1) vertices.
-  void enumerate_final_step(const std::vector<Graph>&);
+  void enumerate_final_step(const GraphStore&);
 
   // Prints the content of the canonicals after the growth to console and log files.
-  void print_before_final(const std::vector<Graph> collected_graphs[MAX_VERTICES]) const;
+  void print_before_final(const GraphStore collected_graphs[MAX_VERTICES]) const;
   void print_state_to_stream(std::ostream& os,
-                             const std::vector<Graph> collected_graphs[MAX_VERTICES]) const;
+                             const GraphStore collected_graphs[MAX_VERTICES]) const;
 
   // The entry point of the worker thread, used in the final enumeration phase.
   void worker_thread_main(int thread_id);
 
+  // A task of the final enumeration phase: the edge sets in `range` of the base graph with id
+  // base_graph_id. Each base graph starts as one task with all its edge sets. When a thread is
+  // idle, the tasks using the EdgeGenerator are split to give it some of their edge sets (see
+  // EdgeGenerator::split_range()), so a few slow base graphs don't leave the other threads idle.
+  struct FinalTask {
+    int base_graph_id;
+    EdgeSetRange range;
+    // The min ratio known when the task is created, used by the min ratio optimization.
+    Fraction min_ratio = Fraction::infinity();
+    // Whether the base graph has other tasks, i.e. this task is split off, or it's split.
+    bool is_split = false;
+  };
+  // The base graph ids claimed by a thread and not taken yet, [next, end).
+  struct BaseGraphChunk {
+    int next = 0;
+    int end = 0;
+  };
+  // The results of the finished tasks of a base graph, merged until all its tasks are finished.
+  struct FinalBaseResult {
+    int unfinished_tasks = 1;
+    // Whether any task is finished, and whether min_ratio_graph is a graph found by a task,
+    // instead of a graph from the previous base graph of the thread (with min_ratio infinity).
+    bool has_result = false;
+    bool found = false;
+    Fraction min_ratio = Fraction::infinity();
+    Graph min_ratio_graph;
+  };
+  // A task has at least this many candidates not fixed by its range when it's split off.
+  static constexpr int MIN_SPLIT_FREE_COUNT = 5;
+  // A thread claims at most this many base graph ids at a time (see take_final_task()).
+  static constexpr int MAX_CHUNK_SIZE = 16;
+
+  // Takes the next task to work on. It's the next base graph in `chunk` of the thread, or in a
+  // new chunk claimed from the atomic to_be_processed_id without a lock. If there is none, it's a
+  // split off task, or waits until a busy thread splits its task, or all the tasks are finished,
+  // in which case returns false.
+  bool take_final_task(BaseGraphChunk& chunk, FinalTask& task);
+  // Called by a thread enumerating `task` with edge_gen when split_requested is set. Splits off
+  // the remaining edge sets of the task to the idle threads if possible. Returns false if the
+  // task can't be split any more.
+  bool split_final_task(FinalTask& task, EdgeGenerator& edge_gen, Fraction min_ratio);
+  // Merges the result of a finished task of a split base graph. If it's the last task of the
+  // base graph, returns true and sets min_ratio and min_ratio_graph to the result of the base
+  // graph.
+  bool finish_split_task(int base_graph_id, bool found, Fraction& min_ratio,
+                         Graph& min_ratio_graph);
+
   // The mutex to protect the counters under multi-threading.
   std::mutex counters_mutex;
-  // The mutex to protect the queue and results under multi-threading.
+  // The mutex to protect the queue and results under multi-threading, also used for the base
+  // graphs of the growth steps.
   std::mutex queue_mutex;
-  // The queue of base graphs to be processed in the final enumeration phase.
-  // The worker threads will dequeue graphs from this queue to work on.
-  std::queue<Graph> to_be_processed;
-  // The results of the final enumeration step.
+  // The base graphs to be processed in the final enumeration phase, which are the graphs with
+  // ids in [to_be_processed_id, to_be_processed_end) in final_base_graphs. The worker threads
+  // claim chunks of ids from the front of this range with an atomic update, and unpack the
+  // graphs.
+  const GraphStore* final_base_graphs;
+  int to_be_processed_end;
+  // The results of the final enumeration step. Each worker thread collects its results, and adds
+  // them here when it's done.
   // Values: 3-tuple (
   //    id of the graph,
   //    the base graph,
   //    the graph with the minimum ratio among all graphs generated from the base graph).
   std::vector<std::tuple<int, Graph, Graph>> results;
-  // The number of graphs that have been dequeued from the to_be_processed queue.
-  int to_be_processed_id;
+  // The id of the next graph to be processed.
+  std::atomic<int> to_be_processed_id;
+  // The tasks split off from the base graphs being processed, which are taken before the next
+  // base graph, and the merged results of these base graphs, protected by queue_mutex.
+  std::deque<FinalTask> split_tasks;
+  std::unordered_map<int, FinalBaseResult> base_results;
+  // The numbers of the threads working on a task (or about to take one), and waiting for one,
+  // protected by queue_mutex.
+  int busy_threads;
+  int idle_threads;
+  // Notified when tasks are split off, or the last busy thread finishes.
+  std::condition_variable task_available;
+  // Set when a thread is idle, asking the busy threads to split their tasks.
+  std::atomic<bool> split_requested;
 
  protected:
-  // Returns the ratio of the given graph.
+  // Returns the table of the ratio values by the edge counts.
   // The subclass must override this function, to implement which ratio to minimize in the search
-  // which may be theta_ratio, zeta_ratio, etc.
-  virtual Fraction get_ratio(const Graph& g) const = 0;
+  // which may be theta_ratio (Graph::THETA_RATIOS), zeta_ratio (Graph::ZETA_RATIOS), etc.
+  virtual const RatioTable& get_ratio_table() const = 0;
+
+  // Returns the ratio of the given graph.
+  Fraction get_ratio(const Graph& g) const {
+    return get_ratio_table().get_ratio(g.get_undirected_edge_count(), g.get_directed_edge_count());
+  }
+
+  // Returns the bound of the ratio, used by the min ratio optimization in the final step to skip
+  // the edge sets that can't give a smaller ratio (see RatioBound). It must be for the ratio of
+  // get_ratio_table(), e.g. RatioBound::THETA or RatioBound::ZETA. The subclass can override this
+  // function to enable the optimization. By default it returns null, and the final step visits
+  // every edge set without a forbidden subgraph.
+  virtual const RatioBound* get_ratio_bound() const { return nullptr; }
 
   // Returns true if g contains a forbidden subgraph, which has v as a vertex.
   // The subclass must override this function to implement which subgraph to forbid.
+  // The forbidden subgraphs must be closed under adding edges, which holds for every subgraph
+  // definition that allows deleting edges: once an edge set contains one, the edge sets that are
+  // its supersets are skipped (see EdgeGenerator::notify_contain_tk_skip()).
   virtual bool contains_forbidden_subgraph(Graph& g, int v) const = 0;
 
+  // Same as above, but g without the given edges (which all contain v) is known to have no
+  // forbidden subgraph with v as a vertex, so only the subgraphs containing at least one of the
+  // given edges need to be checked. The subclass can override this function to implement the
+  // incremental check. By default it checks the whole graph.
+  virtual bool contains_forbidden_subgraph_with_edges(Graph& g, int v, const Edge edges[],
+                                                      int edge_count) const {
+    return contains_forbidden_subgraph(g, v);
+  }
+
+  // Same as above, where g is the graph just generated by edge_gen, and v is the new vertex, so
+  // the subclass can override this function to check the current edge set of edge_gen instead
+  // (e.g. with the tables precomputed for the base graph). By default only the edges that are
+  // new since the last graph without a forbidden subgraph are checked, with the function above.
+  virtual bool contains_forbidden_subgraph_generated(Graph& g, int v,
+                                                     EdgeGenerator& edge_gen) const;
+
+  // Returns true if the base graph of edge_gen with the candidates in candidate_mask (in their
+  // current states) contains a forbidden subgraph with the new vertex v, used to skip the supersets
+  // of the subsets of the current edge set in the final step. By default the graph is generated
+  // and checked with contains_forbidden_subgraph(). The subclass can override this function to
+  // check the candidates directly (e.g. with the tables precomputed for the base graph).
+  virtual bool contains_forbidden_subgraph_in_candidates(int v, EdgeGenerator& edge_gen,
+                                                         uint64 candidate_mask) const;
+
+  // Returns the solver of the orientation problem for the given candidates and base graph, used
+  // by the skeleton search in the final step (see SkeletonSearcher). The subclass can override
+  // this function to support the skeleton search, where the ratio must be theta_ratio. By default
+  // it returns null, and the final step enumerates the edge sets instead.
+  virtual std::unique_ptr<OrientationSolver> create_orientation_solver(
+      const EdgeCandidates& edge_candidates, const Graph& base) const {
+    return nullptr;
+  }
+
+ private:
+  // Returns true if g, the graph just generated by edge_gen, contains a forbidden subgraph
+  // which has v as a vertex. If the contains T_k optimization is enabled, the check uses
+  // contains_forbidden_subgraph_generated(), otherwise the whole graph is checked.
+  // If g doesn't contain a forbidden subgraph, edge_gen is notified.
+  bool check_forbidden_subgraph(Graph& g, int v, EdgeGenerator& edge_gen) const;
+
+  // Adds the stats of the generator or the searchers to the Counters, and clears them.
+  static void observe_edge_stats(EdgeGenerator& edge_gen);
+  static void observe_edge_stats(EdgeSearcher& edge_searcher);
+  static void observe_edge_stats(SkeletonSearcher& skeleton_searcher);
+
  public:
   // Constructs the Grower object.
   // log_stream is used for status reporting and debugging purpose.
@@ -102,4 +256,32 @@ class Grower {
   // For debugging and testing purpose: override the number of generations and seconds
   // between printing stats.
   void set_stats_print_interval(uint64 check_every_n_gen, int print_every_n_seconds);
+
+  // Selects the depth-first EdgeSearcher (if true) or the EdgeGenerator odometer (if false,
+  // the default) for the final enumeration phase. Both give the same results.
+  void set_use_edge_searcher(bool use_searcher) { use_edge_searcher = use_searcher; }
+
+  // Selects the SkeletonSearcher for the final enumeration phase if true (and supported by the
+  // subclass), which is false by default. It gives the same min ratio for each base graph as the
+  // other two, but may find a different graph with the min ratio. The symmetry breaking and the
+  // choice of the edge searcher are ignored when it's used.
+  void set_use_skeleton_search(bool use_skeleton) { use_skeleton_search = use_skeleton; }
+
+  // Selects the search by the edge count targets for the final enumeration phase if true, which
+  // is false by default. It gives the same min ratio for each base graph, but may find a
+  // different graph with the min ratio.
+  void set_use_target_search(bool use_target) { use_target_search = use_target; }
+
+  // Enables or disables the symmetry breaking with the base graph automorphisms in the final
+  // enumeration phase (disabled by default). It gives the same results either way.
+  void set_use_symmetry_breaking(bool use_symmetry) { use_symmetry_breaking = use_symmetry; }
+
+  // Sets the order of the edge candidates of each base graph (NATURAL by default). It gives the
+  // same graphs in the growth steps and the same min ratio for each base graph, but may find a
+  // different graph with the min ratio, and the ratio-graph search may report the graphs in a
+  // different order.
+  void set_candidate_order(CandidateOrder order) { candidate_order = order; }
+
+  // Allows the benchmark to run grow_step() to get the graphs in the growth levels.
+  friend class GraphBenchmark;
 };
\ No newline at end of file
@@ -62,6 +62,10 @@ int main(int argc, char* argv[]) {
   GrowerTk s(t, skip_final_enum, true, true, start_idx, end_idx, search_theta_graphs,
              Fraction(theta_n, theta_d));
   s.set_logging(Counters::log, Counters::log_detail, Counters::log_result);
+  s.set_use_edge_searcher(true);
+  s.set_use_symmetry_breaking(true);
+  s.set_use_skeleton_search(true);
+  s.set_candidate_order(CandidateOrder::LOW_DEGREE);
   s.grow();
   Counters::print_done_message();
   Counters::close_logging();
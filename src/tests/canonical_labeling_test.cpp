@@ -0,0 +1,77 @@
+#include "../canonical_labeling.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using namespace testing;
+
+// Runs the canonical labeling on the given edges, with all n vertices in one initial cell.
+// Returns the relabeled edges, as sorted (vertex_set, head_vertex) pairs. The number of leaves
+// visited and automorphisms found are stored in `leaves` and `automorphisms`.
+std::vector<std::pair<int, int>> canonical_edges(int n, const std::vector<Edge>& edges,
+                                                 uint32& leaves, uint32& automorphisms) {
+  uint8 order[MAX_VERTICES];
+  for (int v = 0; v < n; v++) order[v] = v;
+  CanonicalLabeling labeling(n, edges.size(), edges.data(), order, 1);
+  labeling.run();
+
+  std::vector<std::pair<int, int>> result;
+  uint16 used = 0;
+  for (int v = 0; v < n; v++) {
+    used |= 1 << labeling.labels[v];
+  }
+  EXPECT_EQ(used, (1 << n) - 1);
+  for (const Edge& e : edges) {
+    int vertex_set = 0;
+    for (int v = 0; v < n; v++) {
+      if ((e.vertex_set & (1 << v)) != 0) vertex_set |= 1 << labeling.labels[v];
+    }
+    int head = e.head_vertex == UNDIRECTED ? UNDIRECTED : labeling.labels[e.head_vertex];
+    result.push_back(std::make_pair(vertex_set, head));
+  }
+  std::sort(result.begin(), result.end());
+  leaves = labeling.stats_leaves;
+  automorphisms = labeling.stats_automorphisms;
+  return result;
+}
+
+TEST(CanonicalLabelingTest, KeepsInitialCellOrder) {
+  Graph::set_global_graph_info(2, 4);
+  Edge edges[2]{Edge(0b0011, UNDIRECTED), Edge(0b1100, 3)};
+  uint8 order[4]{3, 2, 1, 0};
+  CanonicalLabeling labeling(4, 2, edges, order, 0b0101);
+  labeling.run();
+  EXPECT_THAT(labeling.labels[3], AnyOf(0, 1));
+  EXPECT_THAT(labeling.labels[2], AnyOf(0, 1));
+  EXPECT_THAT(labeling.labels[1], AnyOf(2, 3));
+  EXPECT_THAT(labeling.labels[0], AnyOf(2, 3));
+  EXPECT_NE(labeling.labels[0], labeling.labels[1]);
+  EXPECT_NE(labeling.labels[2], labeling.labels[3]);
+}
+
+TEST(CanonicalLabelingTest, DirectedCycle) {
+  Graph::set_global_graph_info(2, 12);
+  // Two labelings of the directed cycle on 12 vertices get the same canonical edges.
+  std::vector<Edge> cycle, shuffled;
+  int p[12]{5, 3, 11, 0, 8, 1, 10, 2, 6, 9, 4, 7};
+  for (int v = 0; v < 12; v++) {
+    int u = (v + 1) % 12;
+    cycle.push_back(Edge((1 << v) | (1 << u), u));
+    shuffled.push_back(Edge((1 << p[v]) | (1 << p[u]), p[u]));
+  }
+  uint32 leaves, automorphisms;
+  auto shuffled_result = canonical_edges(12, shuffled, leaves, automorphisms);
+  EXPECT_EQ(canonical_edges(12, cycle, leaves, automorphisms), shuffled_result);
+  // The automorphisms (rotations) are found and used to prune the search tree.
+  EXPECT_GT(automorphisms, 0);
+  EXPECT_LT(leaves, 24);
+}
+
+TEST(CanonicalLabelingTest, EmptyGraph) {
+  Graph::set_global_graph_info(2, 12);
+  // All 12! permutations are automorphisms, but only a small number of leaves are visited.
+  uint32 leaves, automorphisms;
+  EXPECT_TRUE(canonical_edges(12, {}, leaves, automorphisms).empty());
+  EXPECT_GT(automorphisms, 0);
+  EXPECT_LT(leaves, 100);
+}
@@ -280,6 +280,52 @@ TEST(EdgeGeneratorTest, Generate45) {
   }
 }
 
+TEST(EdgeGeneratorTest, CandidateOrder) {
+  Graph::set_global_graph_info(2, 5);
+  Graph base;
+  // The degrees of the candidates {04, 14, 24, 34} are 1, 2, 2, 3.
+  EXPECT_TRUE(Graph::parse_edges("{03, 13>1, 23, 12>2}", base));
+  EdgeCandidates natural(5, base, CandidateOrder::NATURAL);
+  EdgeCandidates high(5, base, CandidateOrder::HIGH_DEGREE);
+  EdgeCandidates low(5, base, CandidateOrder::LOW_DEGREE);
+  EXPECT_THAT(std::vector<uint16>(natural.edge_candidates, natural.edge_candidates + 4),
+              ElementsAre(0b10001, 0b10010, 0b10100, 0b11000));
+  EXPECT_THAT(std::vector<uint16>(high.edge_candidates, high.edge_candidates + 4),
+              ElementsAre(0b11000, 0b10010, 0b10100, 0b10001));
+  EXPECT_THAT(std::vector<uint16>(low.edge_candidates, low.edge_candidates + 4),
+              ElementsAre(0b10001, 0b10010, 0b10100, 0b11000));
+  // The heads are reordered with the candidates.
+  EXPECT_THAT(std::vector<uint8>(high.edge_candidates_heads[0], high.edge_candidates_heads[0] + 4),
+              ElementsAre(NOT_IN_SET, UNDIRECTED, 3, 4));
+
+  // All orders give the same T_k free graphs, with the T_k skips.
+  auto tk_free_graphs = [](int k, int n, const std::string& base_edges, CandidateOrder order) {
+    Graph::set_global_graph_info(k, n);
+    Graph g;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, g));
+    EdgeCandidates ec(n, g, order);
+    EdgeGenerator edge_gen(ec, g);
+    std::set<std::string> result;
+    Graph copy;
+    while (edge_gen.next(copy)) {
+      if (edge_gen.contains_Tk()) {
+        edge_gen.notify_contain_tk_skip();
+      } else {
+        copy.canonicalize();
+        result.insert(copy.serialize_edges());
+      }
+    }
+    return result;
+  };
+  for (const auto& [k, n, edges] : std::vector<std::tuple<int, int, std::string>>{
+           {2, 6, "{03, 13>1, 23, 12>2, 04>4}"}, {3, 6, "{012, 013>3, 124>1, 234}"}}) {
+    const auto expected = tk_free_graphs(k, n, edges, CandidateOrder::NATURAL);
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(tk_free_graphs(k, n, edges, CandidateOrder::HIGH_DEGREE), expected);
+    EXPECT_EQ(tk_free_graphs(k, n, edges, CandidateOrder::LOW_DEGREE), expected);
+  }
+}
+
 TEST(EdgeGeneratorTest, NotifyContainsT2) {
   Graph::set_global_graph_info(2, 6);
   EdgeCandidates ec(6);
@@ -486,10 +532,111 @@ TEST(EdgeGeneratorTest, MinTheta3) {
   }
   EXPECT_EQ(copy.serialize_edges(), "{012>2, 013>3, 023>3}");
 
-  // Next should be "{012>2, 123}". But it doesn't produce smaller theta. So it should skip some,
-  // to get two directed edges.
+  // Next should be "{012>2, 123}". But it doesn't produce smaller theta, and neither do the
+  // graphs with two new edges (where at most one is directed). So it should skip some, to get
+  // three new edges. Note that three undirected edges already have enough edges to produce a
+  // smaller theta, so it must not skip to two directed edges.
+  EXPECT_TRUE(edge_gen.next(copy, true, Fraction(3, 2)));
+  EXPECT_EQ(copy.serialize_edges(), "{012>2, 013, 023, 123}");
+  // Then a directed edge, which is not skipped either.
   EXPECT_TRUE(edge_gen.next(copy, true, Fraction(3, 2)));
-  EXPECT_EQ(copy.serialize_edges(), "{012>2, 013>0, 023>0, 123}");
+  EXPECT_EQ(copy.serialize_edges(), "{012>2, 013>0, 023, 123}");
+}
+
+TEST(EdgeGeneratorTest, RatioBound) {
+  // Verifies the bounds against the min rank over all the states of the free edges.
+  Graph::set_global_graph_info(3, 6);
+  for (const RatioBound* bound : {&RatioBound::THETA, &RatioBound::ZETA}) {
+    const RatioTable& table = bound->get_ratio_table();
+    for (int u = 0; u <= Graph::TOTAL_EDGES; u++) {
+      for (int d = 0; u + d <= Graph::TOTAL_EDGES; d++) {
+        int expected = table.get_rank(u, d);
+        for (int free = 0; u + d + free <= Graph::TOTAL_EDGES; free++) {
+          for (int directed = 0; directed <= free; directed++) {
+            expected = std::min(expected, table.get_rank(u + free - directed, d + directed));
+          }
+          EXPECT_EQ(bound->min_rank(u, d, free), expected);
+        }
+      }
+    }
+  }
+  EXPECT_TRUE(RatioBound::THETA.is_directed_better());
+  EXPECT_FALSE(RatioBound::ZETA.is_directed_better());
+}
+
+TEST(EdgeGeneratorTest, MinRatio) {
+  // Verifies the min ratio optimization with theta and zeta, with the T_k skips checked by a
+  // function (as for the forbidden subgraphs other than T_k), by comparing with the T_k free
+  // edge sets of the full enumeration that have a smaller ratio. The edge searcher with the same
+  // bound visits the same graphs. The known min ratios are the second smallest and the median
+  // ratios of the T_k free graphs, so some graphs are visited and some are skipped.
+  auto verify = [](int k, int n, const std::string& base_edges, const RatioBound& bound) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    const RatioTable& table = bound.get_ratio_table();
+    auto get_ratio = [&table](const Graph& g) {
+      return table.get_ratio(g.get_undirected_edge_count(), g.get_directed_edge_count());
+    };
+    Graph copy;
+
+    std::vector<std::pair<std::string, Fraction>> tk_free;
+    std::set<Fraction> ratios;
+    EdgeGenerator full(ec, base);
+    while (full.next(copy)) {
+      if (!contains_Tk(copy, n - 1)) {
+        tk_free.push_back({copy.serialize_edges(), get_ratio(copy)});
+        ratios.insert(get_ratio(copy));
+      }
+    }
+    ASSERT_GE(ratios.size(), 3);
+    const std::vector<Fraction> sorted_ratios(ratios.begin(), ratios.end());
+
+    for (Fraction min_ratio : {sorted_ratios[1], sorted_ratios[sorted_ratios.size() / 2]}) {
+      std::vector<std::string> expected;
+      for (const auto& [edges, ratio] : tk_free) {
+        if (ratio < min_ratio) expected.push_back(edges);
+      }
+
+      std::vector<std::string> actual;
+      EdgeGenerator edge_gen(ec, base);
+      edge_gen.set_ratio_bound(&bound);
+      auto contains_in_candidates = [&edge_gen, n](uint64 candidate_mask) {
+        Graph g;
+        edge_gen.generate_graph_in_candidates(g, candidate_mask);
+        return contains_Tk(g, n - 1);
+      };
+      while (edge_gen.next(copy, true, min_ratio)) {
+        if (contains_Tk(copy, n - 1)) {
+          edge_gen.notify_contain_tk_skip(contains_in_candidates);
+        } else if (get_ratio(copy) < min_ratio) {
+          actual.push_back(copy.serialize_edges());
+        }
+      }
+      EXPECT_EQ(actual, expected);
+      EXPECT_LT(edge_gen.stats_edge_sets, full.stats_edge_sets);
+
+      std::vector<std::string> searched;
+      EdgeSearcher searcher(ec, base);
+      searcher.set_ratio_bound(&bound);
+      searcher.search(
+          copy, min_ratio,
+          [n](Graph& g, const Edge& edge) { return contains_Tk_with_edges(g, n - 1, &edge, 1); },
+          [&searched, min_ratio](const Graph& g) {
+            searched.push_back(g.serialize_edges());
+            return min_ratio;
+          });
+      EXPECT_EQ(searched, expected);
+    }
+  };
+  for (const RatioBound* bound : {&RatioBound::THETA, &RatioBound::ZETA}) {
+    verify(2, 5, "{01, 02>2, 13>1, 23}", *bound);
+    verify(2, 6, "{01>1, 02, 13>1, 24, 34>3}", *bound);
+    verify(2, 7, "{01, 12>2, 23, 34>4, 45, 05>0}", *bound);
+    verify(3, 5, "{012>2, 013, 123>3}", *bound);
+    verify(3, 5, "{}", *bound);
+  }
 }
 
 TEST(EdgeGeneratorTest, Stats) {
@@ -512,3 +659,566 @@ TEST(EdgeGeneratorTest, Stats) {
   EXPECT_TRUE(edge_gen.next(copy));
   EXPECT_EQ(edge_gen.stats_edge_sets, 1);
 }
+
+TEST(EdgeGeneratorTest, IncrementalUpdate) {
+  // Runs two generators on the same base graph: one with the same `copy` in all calls, so the
+  // graphs are updated incrementally, and one alternating between two graphs, so the graphs are
+  // always generated from the base graph. Verifies the generated graphs are exactly the same.
+  auto verify = [](int k, int n, const std::string& base_edges, bool use_min_theta_opt,
+                   bool canonicalize_some) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    EdgeGenerator incremental(ec, base);
+    EdgeGenerator generated(ec, base);
+    Fraction min_theta = use_min_theta_opt ? Fraction(2, 1) : Fraction(0, 1);
+
+    Graph copy;
+    Graph fresh_copies[2];
+    int count = 0;
+    while (incremental.next(copy, use_min_theta_opt, min_theta)) {
+      Graph& fresh = fresh_copies[count++ % 2];
+      EXPECT_TRUE(generated.next(fresh, use_min_theta_opt, min_theta));
+      EXPECT_EQ(copy.serialize_edges(), fresh.serialize_edges());
+      EXPECT_EQ(copy.undirected_edge_count, fresh.undirected_edge_count);
+      EXPECT_TRUE(copy.is_identical(fresh));
+      for (int v = 0; v < n; v++) {
+        EXPECT_EQ(copy.vertices[v].get_degrees(), fresh.vertices[v].get_degrees());
+      }
+      // Use the T_k skips, which change the enumeration state by more than one step.
+      if (contains_Tk(copy, n - 1)) {
+        incremental.notify_contain_tk_skip();
+        generated.notify_contain_tk_skip();
+      } else if (canonicalize_some && count % 3 == 0) {
+        // The canonicalized graph can't be updated, and must be generated again.
+        copy.canonicalize();
+      }
+    }
+    EXPECT_FALSE(generated.next(fresh_copies[0], use_min_theta_opt, min_theta));
+  };
+  verify(2, 5, "{01, 02>2, 13>1, 23}", false, false);
+  verify(2, 5, "{01, 02>2, 13>1, 23}", false, true);
+  verify(3, 5, "{012>2, 013, 123>3}", false, true);
+  verify(3, 5, "{012>2, 013, 123>3}", true, false);
+  verify(3, 6, "{012, 013>1, 024>4, 134}", true, false);
+}
+
+TEST(EdgeGeneratorTest, NewEdgesSinceTkFree) {
+  // Verifies that checking T_k only with the edges that are new since the last T_k free graph
+  // gives the same result as checking the whole graph, with the T_k skips and the min_theta
+  // skips changing the enumeration state by more than one step.
+  auto verify = [](int k, int n, const std::string& base_edges, bool use_min_theta_opt) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    EdgeGenerator edge_gen(ec, base);
+    Fraction min_theta = use_min_theta_opt ? Fraction(4, 1) : Fraction(0, 1);
+
+    Graph copy;
+    Edge new_edges[MAX_EDGES];
+    int tk_count = 0;
+    int tk_free_count = 0;
+    while (edge_gen.next(copy, use_min_theta_opt, min_theta)) {
+      int count = edge_gen.get_new_edges_since_tk_free(new_edges);
+      EXPECT_LE(count, copy.get_edge_count() - base.get_edge_count());
+      bool contains = contains_Tk(copy, n - 1);
+      EXPECT_EQ(contains_Tk_with_edges(copy, n - 1, new_edges, count), contains);
+      if (contains) {
+        ++tk_count;
+        edge_gen.notify_contain_tk_skip();
+      } else {
+        ++tk_free_count;
+        edge_gen.notify_tk_free();
+        EXPECT_EQ(edge_gen.get_new_edges_since_tk_free(new_edges), 0);
+      }
+    }
+    EXPECT_GT(tk_count, 0);
+    EXPECT_GT(tk_free_count, 0);
+  };
+  verify(2, 5, "{01, 02>2, 13>1, 23}", false);
+  verify(2, 6, "{01>1, 02, 13>1, 24, 34>3}", false);
+  verify(3, 5, "{012>2, 013, 123>3}", false);
+  verify(3, 5, "{012>2, 013, 123>3}", true);
+  verify(3, 6, "{012, 013>1, 024>4, 134}", false);
+  verify(3, 6, "{012, 013>1, 024>4, 134}", true);
+  verify(4, 6, "{0123, 0124, 1234>2}", false);
+}
+
+TEST(EdgeGeneratorTest, ContainsTkConflicts) {
+  // Verifies the T_k check with the conflict tables against contains_Tk(), on random base graphs.
+  // The small cases enumerate all edge sets, the others use the T_k skips.
+  std::mt19937 random_engine(0);
+  auto verify = [&random_engine](int k, int n, bool use_skip) {
+    Graph::set_global_graph_info(k, n);
+    EdgeCandidates ec(n);
+    std::uniform_int_distribution<> state_random(0, k + 1);
+    int tk_count = 0;
+    int tk_free_count = 0;
+    for (int b = 0; b < 20; b++) {
+      // A random base graph with n-1 vertices.
+      Graph base;
+      for (uint16 mask = 0; mask < (1 << (n - 1)); mask++) {
+        if (__builtin_popcount(mask) != k) continue;
+        int state = state_random(random_engine);
+        if (state == 0) continue;
+        uint16 m = mask;
+        for (int j = 2; j < state; j++) m &= m - 1;
+        base.add_edge(Edge(mask, state == 1 ? UNDIRECTED : __builtin_ctz(m)));
+      }
+      EdgeGenerator edge_gen(ec, base);
+      Graph copy;
+      while (edge_gen.next(copy)) {
+        bool contains = contains_Tk(copy, n - 1);
+        EXPECT_EQ(edge_gen.contains_Tk(), contains);
+        if (contains) {
+          ++tk_count;
+          if (use_skip) edge_gen.notify_contain_tk_skip();
+        } else {
+          ++tk_free_count;
+        }
+      }
+    }
+    EXPECT_GT(tk_count, 0);
+    EXPECT_GT(tk_free_count, 0);
+  };
+  verify(2, 5, false);
+  verify(2, 6, false);
+  verify(3, 5, false);
+  verify(2, 7, true);
+  verify(3, 6, true);
+  verify(4, 6, true);
+}
+
+TEST(EdgeGeneratorTest, ConflictSkip) {
+  // Verifies the skips with the conflict tables never skip a T_k free edge set, by comparing
+  // with the T_k free edge sets of the full enumeration.
+  auto verify = [](int k, int n, const std::string& base_edges) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    Graph copy;
+
+    std::vector<std::string> expected;
+    EdgeGenerator full(ec, base);
+    while (full.next(copy)) {
+      if (!contains_Tk(copy, n - 1)) expected.push_back(copy.serialize_edges());
+    }
+
+    std::vector<std::string> actual;
+    EdgeGenerator edge_gen(ec, base);
+    while (edge_gen.next(copy)) {
+      if (edge_gen.contains_Tk()) {
+        edge_gen.notify_contain_tk_skip();
+      } else {
+        actual.push_back(copy.serialize_edges());
+      }
+    }
+    EXPECT_EQ(actual, expected);
+    EXPECT_GT(edge_gen.stats_tk_conflict_skip, 0);
+    EXPECT_LT(edge_gen.stats_edge_sets, full.stats_edge_sets);
+  };
+  verify(2, 5, "{01, 02>2, 13>1, 23}");
+  verify(2, 6, "{01>1, 02, 13>1, 24, 34>3}");
+  verify(2, 7, "{01, 12>2, 23, 34>4, 45, 05>0}");
+  verify(3, 5, "{012>2, 013, 123>3}");
+  verify(3, 6, "{012, 013>1, 024>4, 134}");
+}
+
+TEST(EdgeGeneratorTest, CandidateSymmetry) {
+  // Verifies is_first() and its skips for all enumeration states, with the images computed from
+  // the automorphisms of the base graph directly.
+  auto verify = [](int k, int n, const std::string& base_edges, int automorphism_count) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    CandidateSymmetry symmetry(ec, base);
+    EXPECT_EQ(symmetry.size(), automorphism_count);
+    std::vector<std::array<uint8, MAX_VERTICES>> automorphisms;
+    base.compute_automorphisms(n - 1, CandidateSymmetry::MAX_AUTOMORPHISMS, automorphisms);
+
+    const int count = ec.edge_candidate_count;
+    auto is_first = [&](const std::vector<uint8>& state) {
+      for (const auto& a : automorphisms) {
+        std::vector<uint8> image(count);
+        for (int i = 0; i < count; i++) {
+          uint16 vertex_set = 0;
+          for (uint32 m = ec.edge_candidates[i]; m != 0; m &= m - 1) {
+            vertex_set |= 1 << a[__builtin_ctz(m)];
+          }
+          int j = std::find(ec.edge_candidates, ec.edge_candidates + count, vertex_set) -
+                  ec.edge_candidates;
+          uint8 head = ec.edge_candidates_heads[i][state[i]];
+          if (state[i] >= 2) head = a[head];
+          image[j] = std::find(ec.edge_candidates_heads[j], ec.edge_candidates_heads[j] + k + 2,
+                               head) -
+                     ec.edge_candidates_heads[j];
+        }
+        // The enumeration order compares the highest candidate first.
+        if (std::lexicographical_compare(image.rbegin(), image.rend(), state.rbegin(),
+                                         state.rend())) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    std::vector<uint8> state(count, 0);
+    int first_count = 0;
+    while (true) {
+      int skip;
+      const bool first = is_first(state);
+      EXPECT_EQ(symmetry.is_first(state.data(), skip), first);
+      if (first) {
+        ++first_count;
+      } else {
+        // The states that differ in the skipped digits don't come first either.
+        EXPECT_GE(skip, 0);
+        for (int fill : {0, k + 1}) {
+          std::vector<uint8> other = state;
+          std::fill(other.begin(), other.begin() + skip, fill);
+          EXPECT_FALSE(is_first(other));
+        }
+      }
+      int i = 0;
+      while (i < count && ++state[i] == k + 2) state[i++] = 0;
+      if (i == count) break;
+    }
+    return first_count;
+  };
+
+  // Any permutation of 0..3 for the empty base graph, and only 35 of the 4^4 states come first.
+  EXPECT_EQ(verify(2, 5, "{}", 23), 35);
+  EXPECT_EQ(verify(2, 5, "{01}", 3), 100);
+  EXPECT_EQ(verify(2, 6, "{01, 23}", 7), 220);
+  EXPECT_EQ(verify(3, 5, "{}", 23), 785);
+  EXPECT_EQ(verify(3, 5, "{012>2}", 1), 8000);
+  // No automorphism, nothing is skipped.
+  EXPECT_EQ(verify(3, 5, "{012>2, 013>0}", 0), 15625);
+}
+
+TEST(EdgeGeneratorTest, SymmetryBreaking) {
+  // With the symmetry breaking, the generator skips some edge sets, but still generates the same
+  // graphs up to isomorphism.
+  auto verify = [](int k, int n, const std::string& base_edges) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    CandidateSymmetry symmetry(ec, base);
+    EdgeGenerator all(ec, base);
+    EdgeGenerator first(ec, base);
+    first.set_symmetry(&symmetry);
+
+    auto generate = [](EdgeGenerator& edge_gen) {
+      std::set<std::string> graphs;
+      Graph copy;
+      while (edge_gen.next(copy)) {
+        Graph g = copy;
+        g.canonicalize();
+        graphs.insert(g.serialize_edges());
+      }
+      return graphs;
+    };
+    EXPECT_EQ(generate(all), generate(first));
+    EXPECT_LT(first.stats_edge_sets, all.stats_edge_sets);
+    EXPECT_GT(first.stats_symmetry_skip, 0);
+  };
+  verify(2, 5, "{}");
+  verify(2, 6, "{01, 23}");
+  verify(3, 5, "{012>2}");
+}
+
+TEST(EdgeGeneratorTest, SplitRange) {
+  Graph::set_global_graph_info(2, 5);
+  Graph empty;
+  EdgeCandidates ec(5);
+  EdgeGenerator edge_gen(ec, empty);
+  Graph copy;
+  EXPECT_TRUE(edge_gen.next(copy));
+  EXPECT_EQ(copy.serialize_edges(), "{04}");
+  // The edge sets after {04} with the top candidate {34} in states 1..3 are split off, and then
+  // the ones with {24} in states 1..3 (with {34} absent).
+  std::vector<EdgeSetRange> ranges;
+  EXPECT_EQ(edge_gen.split_range(2, ranges), 3);
+  EXPECT_EQ(edge_gen.split_range(2, ranges), 3);
+  EXPECT_EQ(edge_gen.split_range(2, ranges), 0);
+  ASSERT_EQ(ranges.size(), 6);
+  EXPECT_EQ(ranges[2].fixed_count, 1);
+  EXPECT_EQ(ranges[2].states[3], 3);
+  EXPECT_EQ(ranges[4].fixed_count, 2);
+  EXPECT_EQ(ranges[4].states[2], 2);
+  EXPECT_EQ(ranges[4].states[3], 0);
+  // The rest of the range of this generator, and the first split off range.
+  int count = 0;
+  while (edge_gen.next(copy)) ++count;
+  EXPECT_EQ(count, 14);
+  EdgeGenerator split(ec, empty);
+  split.set_range(ranges[0]);
+  EXPECT_TRUE(split.next(copy));
+  EXPECT_EQ(copy.serialize_edges(), "{34}");
+
+  // Splits the range of each generator after every `split_every` edge sets until it can't be
+  // split any more, and enumerates the split off ranges with new generators. Together they visit
+  // the same edge sets as the full enumeration, with the T_k skips, the min ratio optimization
+  // and the symmetry breaking.
+  auto verify = [](int k, int n, const std::string& base_edges) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    CandidateSymmetry symmetry(ec, base);
+    const RatioTable& table = RatioBound::THETA.get_ratio_table();
+
+    // Returns the T_k free edge sets with a ratio < min_ratio, and their ratios, sorted.
+    auto generate = [&](int split_every, Fraction min_ratio, bool use_symmetry) {
+      std::vector<std::pair<std::string, Fraction>> result;
+      std::vector<EdgeSetRange> ranges(1);
+      int range_count = 0;
+      Graph copy;
+      while (!ranges.empty()) {
+        EdgeGenerator edge_gen(ec, base);
+        if (use_symmetry) edge_gen.set_symmetry(&symmetry);
+        edge_gen.set_range(ranges.back());
+        ranges.pop_back();
+        ++range_count;
+        auto contains_in_candidates = [&edge_gen, n](uint64 candidate_mask) {
+          Graph g;
+          edge_gen.generate_graph_in_candidates(g, candidate_mask);
+          return contains_Tk(g, n - 1);
+        };
+        while (edge_gen.next(copy, true, min_ratio)) {
+          if (split_every > 0 && edge_gen.stats_edge_sets % split_every == 0) {
+            edge_gen.split_range(1, ranges);
+          }
+          const Fraction ratio =
+              table.get_ratio(copy.get_undirected_edge_count(), copy.get_directed_edge_count());
+          if (contains_Tk(copy, n - 1)) {
+            edge_gen.notify_contain_tk_skip(contains_in_candidates);
+          } else if (ratio < min_ratio) {
+            result.push_back({copy.serialize_edges(), ratio});
+          }
+        }
+      }
+      if (split_every == 1) EXPECT_GT(range_count, 1);
+      std::sort(result.begin(), result.end());
+      return result;
+    };
+
+    const auto all = generate(0, Fraction::infinity(), false);
+    ASSERT_GE(all.size(), 3);
+    std::vector<Fraction> ratios;
+    for (const auto& [edges, ratio] : all) ratios.push_back(ratio);
+    std::sort(ratios.begin(), ratios.end());
+    for (Fraction min_ratio : {Fraction::infinity(), ratios[ratios.size() / 2]}) {
+      for (bool use_symmetry : {false, true}) {
+        const auto expected = generate(0, min_ratio, use_symmetry);
+        for (int split_every : {1, 3, 20}) {
+          EXPECT_EQ(generate(split_every, min_ratio, use_symmetry), expected);
+        }
+      }
+    }
+  };
+  verify(2, 5, "{}");
+  verify(2, 6, "{01>1, 02, 13>1, 24, 34>3}");
+  verify(2, 7, "{01, 12>2, 23, 34>4, 45, 05>0}");
+  verify(3, 5, "{012>2}");
+  verify(3, 6, "{012, 013>1, 024>4, 134}");
+}
+
+TEST(EdgeGeneratorTest, TkOrientationSolver) {
+  // Verifies the solver against the best orientation of each skeleton found by enumerating all
+  // edge sets, on random base graphs.
+  std::mt19937 random_engine(0);
+  auto verify = [&random_engine](int k, int n) {
+    Graph::set_global_graph_info(k, n);
+    EdgeCandidates ec(n);
+    const int count = ec.edge_candidate_count;
+    std::uniform_int_distribution<> state_random(0, k + 1);
+    int infeasible_count = 0;
+    for (int b = 0; b < 10; b++) {
+      Graph base;
+      for (uint16 mask = 0; mask < (1 << (n - 1)); mask++) {
+        if (__builtin_popcount(mask) != k) continue;
+        int state = state_random(random_engine);
+        if (state == 0) continue;
+        uint16 m = mask;
+        for (int j = 2; j < state; j++) m &= m - 1;
+        base.add_edge(Edge(mask, state == 1 ? UNDIRECTED : __builtin_ctz(m)));
+      }
+
+      // The maximum number of directed candidates of each skeleton, or -1 if none is T_k free.
+      std::vector<int> expected(1 << count, -1);
+      expected[0] = 0;
+      EdgeGenerator edge_gen(ec, base);
+      Graph copy;
+      while (edge_gen.next(copy)) {
+        if (contains_Tk(copy, n - 1)) continue;
+        uint32 skeleton = 0;
+        int directed = 0;
+        for (int i = 0; i < count; i++) {
+          if (copy.has_edge_rank(Graph::EDGE_RANKS[ec.edge_candidates[i]])) {
+            skeleton |= 1 << i;
+            if (copy.get_head_rank(Graph::EDGE_RANKS[ec.edge_candidates[i]]) != UNDIRECTED) {
+              ++directed;
+            }
+          }
+        }
+        expected[skeleton] = std::max(expected[skeleton], directed);
+      }
+
+      // The same solver is used for all skeletons, adding the candidates from the highest one
+      // like the searcher, and removing them afterwards.
+      TkOrientationSolver solver(ec, base);
+      for (uint32 skeleton = 1; skeleton < (1u << count); skeleton++) {
+        std::vector<int> added;
+        bool feasible = true;
+        for (int i = count - 1; i >= 0 && feasible; i--) {
+          if ((skeleton & (1 << i)) == 0) continue;
+          feasible = solver.add(i);
+          if (feasible) added.push_back(i);
+        }
+        if (!feasible) {
+          ++infeasible_count;
+          EXPECT_EQ(expected[skeleton], -1);
+        } else {
+          EXPECT_EQ(solver.max_directed(), expected[skeleton]);
+          EXPECT_EQ(solver.min_undirected(), __builtin_popcount(skeleton) - expected[skeleton]);
+          uint8 state[MAX_EDGES];
+          solver.orient(state);
+          base.copy_edges(copy);
+          int directed = 0;
+          for (int i = 0; i < count; i++) {
+            EXPECT_EQ(state[i] != 0, (skeleton & (1 << i)) != 0);
+            if (state[i] == 0) continue;
+            if (state[i] >= 2) ++directed;
+            copy.add_edge(Edge(ec.edge_candidates[i], ec.edge_candidates_heads[i][state[i]]));
+          }
+          EXPECT_EQ(directed, expected[skeleton]);
+          EXPECT_FALSE(contains_Tk(copy, n - 1));
+        }
+        for (auto it = added.rbegin(); it != added.rend(); ++it) {
+          solver.remove(*it);
+        }
+        EXPECT_EQ(solver.max_directed(), 0);
+      }
+    }
+    EXPECT_GT(infeasible_count, 0);
+  };
+  verify(2, 5);
+  verify(2, 6);
+  verify(2, 7);
+  verify(3, 5);
+}
+
+TEST(EdgeGeneratorTest, SkeletonSearcher) {
+  // The skeleton searcher finds the same min_theta as the generator, and visits fewer graphs.
+  auto verify = [](int k, int n, const std::string& base_edges) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    Graph copy;
+
+    Fraction expected = Fraction::infinity();
+    EdgeGenerator edge_gen(ec, base);
+    while (edge_gen.next(copy, true, expected)) {
+      if (edge_gen.contains_Tk()) {
+        edge_gen.notify_contain_tk_skip();
+      } else {
+        expected = std::min(expected, copy.get_theta_ratio());
+      }
+    }
+
+    Fraction actual = Fraction::infinity();
+    SkeletonSearcher searcher(ec, base);
+    TkOrientationSolver solver(ec, base);
+    searcher.search(
+        copy, solver, actual,
+        [&](const Graph& g) {
+          Graph h = g;
+          EXPECT_FALSE(contains_Tk(h, n - 1));
+          EXPECT_LT(g.get_theta_ratio(), actual);
+          actual = g.get_theta_ratio();
+          return actual;
+        },
+        []() {});
+    EXPECT_EQ(actual, expected);
+    EXPECT_LE(searcher.stats_edge_sets, edge_gen.stats_edge_sets);
+    EXPECT_GT(searcher.stats_theta_prunes, 0);
+  };
+  verify(2, 6, "{01, 02>2, 13>1, 23}");
+  verify(2, 7, "{01, 12>2, 23, 34>4, 45, 05>0}");
+  verify(3, 6, "{012, 013>1, 024>4, 134}");
+  verify(3, 6, "{}");
+  verify(4, 6, "{0123, 0124, 1234>2}");
+}
+
+TEST(EdgeGeneratorTest, SearchTarget) {
+  // Verifies the target searches against the edge counts of all T_k free edge sets.
+  auto verify = [](int k, int n, const std::string& base_edges) {
+    Graph::set_global_graph_info(k, n);
+    Graph base;
+    EXPECT_TRUE(Graph::parse_edges(base_edges, base));
+    EdgeCandidates ec(n);
+    const int count = ec.edge_candidate_count;
+    Graph copy;
+
+    // The first T_k free graph with each (undirected, directed) new edge counts.
+    std::map<std::pair<int, int>, std::string> expected;
+    EdgeGenerator edge_gen(ec, base);
+    while (edge_gen.next(copy)) {
+      if (edge_gen.contains_Tk()) {
+        edge_gen.notify_contain_tk_skip();
+        continue;
+      }
+      const int undirected = copy.get_undirected_edge_count() - base.get_undirected_edge_count();
+      const int directed = copy.get_directed_edge_count() - base.get_directed_edge_count();
+      expected.insert({{undirected, directed}, copy.serialize_edges()});
+    }
+
+    auto contains = [n](Graph& g, const Edge& edge) {
+      return contains_Tk_with_edges(g, n - 1, &edge, 1);
+    };
+    CandidateSymmetry symmetry(ec, base);
+    EdgeSearcher searcher(ec, base);
+    EdgeSearcher symmetric_searcher(ec, base);
+    symmetric_searcher.set_symmetry(&symmetry);
+    SkeletonSearcher skeleton_searcher(ec, base);
+    TkOrientationSolver solver(ec, base);
+    int found_count = 0;
+    for (int undirected = 0; undirected <= count; undirected++) {
+      for (int directed = 0; undirected + directed <= count; directed++) {
+        if (undirected + directed == 0) continue;
+        auto it = expected.find({undirected, directed});
+        const bool found = it != expected.end();
+        found_count += found ? 1 : 0;
+        // The edge searcher finds the first graph, and the others find any graph with the counts.
+        EXPECT_EQ(searcher.search_target(copy, undirected, directed, contains), found);
+        if (found) EXPECT_EQ(copy.serialize_edges(), it->second);
+        for (int i = 0; i < 2; i++) {
+          const bool result =
+              i == 0 ? symmetric_searcher.search_target(copy, undirected, directed, contains)
+                     : skeleton_searcher.search_target(copy, solver, undirected, directed, []() {});
+          EXPECT_EQ(result, found);
+          if (!found) continue;
+          EXPECT_EQ(copy.get_undirected_edge_count(),
+                    base.get_undirected_edge_count() + undirected);
+          EXPECT_EQ(copy.get_directed_edge_count(), base.get_directed_edge_count() + directed);
+          EXPECT_FALSE(contains_Tk(copy, n - 1));
+        }
+      }
+    }
+    return found_count;
+  };
+  // The number of possible targets, out of (m+1)(m+2)/2-1 for m candidates. With the empty base
+  // graph every target is possible.
+  EXPECT_EQ(verify(2, 5, "{01, 02>2, 13>1, 23}"), 5);
+  EXPECT_EQ(verify(2, 6, "{01, 02>2, 13>1, 23}"), 9);
+  EXPECT_EQ(verify(3, 5, "{}"), 27);
+  EXPECT_EQ(verify(3, 5, "{012>2, 013, 123>3}"), 12);
+  EXPECT_EQ(verify(3, 6, "{012, 013>1, 024>4, 134}"), 32);
+}
@@ -1,7 +1,9 @@
 // A stress test to verify the correctness of the edge generation algorithm.
 //
 // The idea is to compare the result of Grower.grow(), using different edge gen optimization
-// combinations, and verify that they always match.
+// combinations, the depth-first edge searcher and the symmetry breaking, and verify that they
+// always match. The skeleton search, the target search and the other candidate orders are
+// verified to give the same min ratio for each base graph.
 //
 #include "../counters.h"
 #include "../forbid_tk/graph_tk.h"
@@ -21,6 +23,17 @@ void verify_array_equal(const std::vector<std::tuple<int, Graph, Graph>>& a,
     ASSERT(std::get<2>(a[i]).serialize_edges() == std::get<2>(b[i]).serialize_edges());
   }
 }
+// The skeleton search (or another candidate order) may find a different graph with the same min
+// ratio, so only the base graphs and the ratios are compared.
+void verify_ratios_equal(const std::vector<std::tuple<int, Graph, Graph>>& a,
+                         const std::vector<std::tuple<int, Graph, Graph>>& b) {
+  ASSERT(a.size() == b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    ASSERT(std::get<0>(a[i]) == std::get<0>(b[i]));
+    ASSERT(std::get<1>(a[i]).serialize_edges() == std::get<1>(b[i]).serialize_edges());
+    ASSERT(std::get<2>(a[i]).get_theta_ratio() == std::get<2>(b[i]).get_theta_ratio());
+  }
+}
 void verify(int k, int n) {
   Graph::set_global_graph_info(k, n);
 
@@ -40,9 +53,61 @@ void verify(int k, int n) {
   GrowerTk tt(0, false, true, true, 0, 0);
   tt.grow();
 
+  Counters::initialize();
+  GrowerTk searcher(0, false, true, true, 0, 0);
+  searcher.set_use_edge_searcher(true);
+  searcher.grow();
+
+  Counters::initialize();
+  GrowerTk symmetry(0, false, true, true, 0, 0);
+  symmetry.set_use_symmetry_breaking(true);
+  symmetry.grow();
+
+  Counters::initialize();
+  GrowerTk searcher_symmetry(0, false, true, true, 0, 0);
+  searcher_symmetry.set_use_edge_searcher(true);
+  searcher_symmetry.set_use_symmetry_breaking(true);
+  searcher_symmetry.grow();
+
+  Counters::initialize();
+  GrowerTk skeleton(0, false, true, true, 0, 0);
+  skeleton.set_use_skeleton_search(true);
+  skeleton.grow();
+
+  Counters::initialize();
+  GrowerTk target(0, false, true, true, 0, 0);
+  target.set_use_target_search(true);
+  target.set_use_symmetry_breaking(true);
+  target.grow();
+
+  Counters::initialize();
+  GrowerTk skeleton_target(0, false, true, true, 0, 0);
+  skeleton_target.set_use_skeleton_search(true);
+  skeleton_target.set_use_target_search(true);
+  skeleton_target.grow();
+
+  Counters::initialize();
+  GrowerTk high_degree(0, false, true, true, 0, 0);
+  high_degree.set_candidate_order(CandidateOrder::HIGH_DEGREE);
+  high_degree.grow();
+
+  Counters::initialize();
+  GrowerTk low_degree_searcher(0, false, true, true, 0, 0);
+  low_degree_searcher.set_candidate_order(CandidateOrder::LOW_DEGREE);
+  low_degree_searcher.set_use_edge_searcher(true);
+  low_degree_searcher.grow();
+
   verify_array_equal(ff.get_results(), ft.get_results());
   verify_array_equal(ff.get_results(), tf.get_results());
   verify_array_equal(ff.get_results(), tt.get_results());
+  verify_array_equal(ff.get_results(), searcher.get_results());
+  verify_array_equal(ff.get_results(), symmetry.get_results());
+  verify_array_equal(ff.get_results(), searcher_symmetry.get_results());
+  verify_ratios_equal(ff.get_results(), skeleton.get_results());
+  verify_ratios_equal(ff.get_results(), target.get_results());
+  verify_ratios_equal(ff.get_results(), skeleton_target.get_results());
+  verify_ratios_equal(ff.get_results(), high_degree.get_results());
+  verify_ratios_equal(ff.get_results(), low_degree_searcher.get_results());
 }
 
 int main(int argc, char* argv[]) {
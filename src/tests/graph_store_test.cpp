@@ -0,0 +1,102 @@
+#include "../graph_store.h"
+
+#include "../counters.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using namespace testing;
+
+// Returns a random canonicalized graph, where each edge is absent, undirected, or directed with
+// a random head, with equal probabilities.
+Graph random_graph(std::mt19937& random_engine) {
+  std::uniform_int_distribution<> state_random(0, Graph::K + 1);
+  Graph g;
+  for (int i = 0; i < Graph::TOTAL_EDGES; i++) {
+    uint16 vertex_set = Graph::VERTEX_MASKS[Graph::K].masks[i];
+    int state = state_random(random_engine);
+    if (state == 0) continue;
+    uint8 head = UNDIRECTED;
+    if (state > 1) {
+      // The (state-1)-th vertex in the vertex set.
+      uint16 m = vertex_set;
+      for (int j = 2; j < state; j++) m &= m - 1;
+      head = __builtin_ctz(m);
+    }
+    g.add_edge(Edge(vertex_set, head));
+  }
+  g.canonicalize();
+  return g;
+}
+
+// Verifies that the graphs in the store unpack to exactly the given graphs.
+void verify_store(const GraphStore& store, const std::vector<Graph>& graphs) {
+  ASSERT_EQ(store.size(), graphs.size());
+  for (size_t i = 0; i < graphs.size(); i++) {
+    Graph g = store[i];
+    EXPECT_EQ(g.serialize_edges(), graphs[i].serialize_edges());
+    EXPECT_TRUE(g.is_isomorphic(graphs[i]));
+    EXPECT_FALSE(g < graphs[i] || graphs[i] < g);
+    EXPECT_EQ(store.get_graph_hash(i), graphs[i].get_graph_hash());
+    EXPECT_EQ(store.get_edge_count(i), graphs[i].get_edge_count());
+    EXPECT_EQ(store.get_undirected_edge_count(i), graphs[i].get_undirected_edge_count());
+  }
+}
+
+// Packs random graphs (including an empty graph and duplicates), and verifies the unpacked
+// graphs, the isomorphism checks and the sort order are the same as the Graph functions.
+void verify_random_graphs(int k, int n, size_t bytes_per_graph) {
+  Graph::set_global_graph_info(k, n);
+  std::mt19937 random_engine(k * 100 + n);
+  std::vector<Graph> graphs(1);
+  graphs[0].canonicalize();
+  for (int i = 0; i < 200; i++) {
+    graphs.push_back(random_graph(random_engine));
+  }
+  for (int i = 0; i < 20; i++) {
+    graphs.push_back(graphs[i * 3]);
+  }
+
+  GraphStore store;
+  for (const Graph& g : graphs) {
+    store.push_back(g);
+  }
+  EXPECT_EQ(store.memory_bytes(), graphs.size() * bytes_per_graph);
+  verify_store(store, graphs);
+  for (size_t i = 0; i < graphs.size(); i++) {
+    for (size_t j = 0; j < graphs.size(); j++) {
+      EXPECT_EQ(store.is_isomorphic(i, j), graphs[i].is_isomorphic(graphs[j]));
+    }
+  }
+
+  store.sort();
+  std::sort(graphs.begin(), graphs.end());
+  verify_store(store, graphs);
+}
+
+TEST(GraphStoreTest, RandomGraphs) {
+  // 35 edges: 1 word for the edge bitmap, 3 words for the edge heads, and the hash.
+  verify_random_graphs(3, 7, 36);
+  // 66 edges: 2 words for the edge bitmap, 5 words for the edge heads, and the hash.
+  verify_random_graphs(2, 12, 60);
+  // 70 edges: 2 words for the edge bitmap, 5 words for the edge heads, and the hash.
+  verify_random_graphs(4, 8, 60);
+}
+
+TEST(GraphStoreTest, PushPop) {
+  Graph::set_global_graph_info(3, 5);
+  Graph g, h;
+  EXPECT_TRUE(Graph::parse_edges("{012, 034>3, 124>1}", g));
+  EXPECT_TRUE(Graph::parse_edges("{012, 034>3, 134>1}", h));
+  g.canonicalize();
+  h.canonicalize();
+
+  GraphStore store;
+  store.push_back(g);
+  store.push_back(h);
+  GraphStore other;
+  other.push_back(store, 1);
+  other.push_back(store, 0);
+  other.pop_back();
+  verify_store(other, {h});
+  verify_store(store, {g, h});
+}
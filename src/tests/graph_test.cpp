@@ -74,6 +74,94 @@ TEST(GraphTest, GraphDataStructure) {
   EXPECT_EQ(g.vertices[6].degree_tail, 1);
 }
 
+// Verifies the edge bitmap in g is consistent with its edges array.
+void verify_edge_bitmap(const Graph& g) {
+  const VertexMask& masks = Graph::VERTEX_MASKS[Graph::K];
+  int found = 0;
+  for (int rank = 0; rank < masks.mask_count; rank++) {
+    EXPECT_EQ(Graph::EDGE_RANKS[masks.masks[rank]], rank);
+    EXPECT_EQ(g.has_edge_rank(rank), g.has_edge(masks.masks[rank]));
+    if (!g.has_edge_rank(rank)) continue;
+    ++found;
+    EXPECT_EQ(g.get_head_rank(rank), g.get_head(masks.masks[rank]));
+    EXPECT_FALSE(g.edge_allowed(masks.masks[rank]));
+  }
+  EXPECT_EQ(found, g.get_edge_count());
+}
+
+TEST(GraphTest, EdgeBitmap) {
+  Graph::set_global_graph_info(3, 7);
+  Graph g = parse_edges("{234, 156>5, 123>2, 013}");
+  verify_edge_bitmap(g);
+  for (int i = 0; i < g.edge_count; i++) {
+    EXPECT_TRUE(g.has_edge(g.edges[i].vertex_set));
+    EXPECT_EQ(g.get_head(g.edges[i].vertex_set), g.edges[i].head_vertex);
+  }
+  EXPECT_TRUE(g.edge_allowed(0b1000011));
+  EXPECT_EQ(g.get_head(0b1100010), 5);
+  EXPECT_EQ(g.get_head(0b0011100), UNDIRECTED);
+
+  g.canonicalize();
+  verify_edge_bitmap(g);
+  EXPECT_EQ(g.serialize_edges(), "{012>1, 023, 014, 256>5}");
+  EXPECT_EQ(g.get_head(0b0000111), 1);
+  EXPECT_EQ(g.get_head(0b1100100), 5);
+
+  Graph h;
+  g.copy_edges(h);
+  verify_edge_bitmap(h);
+  h.add_edge(Edge(0b1010100, 6));
+  verify_edge_bitmap(h);
+  EXPECT_EQ(h.get_head(0b1010100), 6);
+
+  int p[7]{0, 1, 2, 4, 3, 5, 6};
+  Graph f;
+  g.permute_for_testing(p, f);
+  verify_edge_bitmap(f);
+  EXPECT_TRUE(f.has_edge(0b0001011));
+  EXPECT_FALSE(f.has_edge(0b0010011));
+
+  EXPECT_TRUE(Graph::parse_edges("{}", f));
+  verify_edge_bitmap(f);
+}
+
+TEST(GraphTest, IncrementalVertexDegrees) {
+  // Verifies the vertex degrees maintained in g are the same as the ones computed from scratch.
+  auto verify_vertex_degrees = [](const Graph& g) {
+    Graph h = g;
+    h.compute_vertex_signature();
+    for (int v = 0; v < MAX_VERTICES; v++) {
+      EXPECT_EQ(g.vertices[v].get_degrees(), h.vertices[v].get_degrees());
+    }
+  };
+
+  Graph::set_global_graph_info(3, 7);
+  Graph g = parse_edges("{234, 156>5, 123>2, 013}");
+  verify_vertex_degrees(g);
+  EXPECT_EQ(g.vertices[1].get_degrees(), 0x010002);
+
+  g.canonicalize();
+  verify_vertex_degrees(g);
+
+  Graph h;
+  g.copy_edges(h);
+  verify_vertex_degrees(h);
+  h.add_edge(Edge(0b1010100, 6));
+  h.add_edge(Edge(0b1011000, UNDIRECTED));
+  verify_vertex_degrees(h);
+  EXPECT_EQ(h.vertices[6].get_degrees(), 0x010101);
+
+  int p[7]{0, 1, 2, 4, 3, 5, 6};
+  Graph f;
+  g.permute_for_testing(p, f);
+  verify_vertex_degrees(f);
+  h.permute_for_testing(p, f);
+  verify_vertex_degrees(f);
+
+  EXPECT_TRUE(Graph::parse_edges("{}", f));
+  verify_vertex_degrees(f);
+}
+
 // Utility function to create and initialize T_3.
 Graph get_T3() {
   Graph::set_global_graph_info(3, 5);
@@ -82,6 +170,25 @@ Graph get_T3() {
   return g;
 }
 
+TEST(GraphTest, VertexSetPermutation) {
+  int p[12]{5, 3, 11, 0, 8, 1, 10, 2, 6, 9, 4, 7};
+  VertexSetPermutation permutation(p, 12);
+  for (int vertex_set = 0; vertex_set < (1 << 12); vertex_set++) {
+    uint16 expected = 0;
+    for (int v = 0; v < 12; v++) {
+      if ((vertex_set & (1 << v)) != 0) expected |= 1 << p[v];
+    }
+    EXPECT_EQ(permutation.apply(vertex_set), expected);
+  }
+  // Fewer than 6 vertices, the high table is only used for the empty set.
+  int q[4]{2, 0, 3, 1};
+  VertexSetPermutation small(q, 4);
+  EXPECT_EQ(small.apply(0b0000), 0b0000);
+  EXPECT_EQ(small.apply(0b0011), 0b0101);
+  EXPECT_EQ(small.apply(0b1110), 0b1011);
+  EXPECT_EQ(small.apply(0b1111), 0b1111);
+}
+
 TEST(GraphTest, T3) {
   Graph g = get_T3();
 
@@ -130,6 +237,122 @@ TEST(GraphTest, IsomorphicSlow) {
   EXPECT_TRUE(h.is_isomorphic_slow(g));
 }
 
+TEST(GraphTest, FindIsomorphism) {
+  Graph::set_global_graph_info(3, 5);
+  Graph g = parse_edges("{013>3, 023>3, 014, 034}");
+  Graph h = parse_edges("{014>0, 034>0, 124, 024}");
+  int p[MAX_VERTICES];
+  EXPECT_TRUE(g.find_isomorphism(h, p));
+  // Applying the mapping to g gives h.
+  Graph f;
+  g.permute_for_testing(p, f);
+  h.finalize_edges();
+  EXPECT_TRUE(f.is_identical(h));
+
+  // Same degrees and codegree info, but not isomorphic.
+  g = parse_edges("{012, 014>1, 034>0, 234>3}");
+  h = parse_edges("{012, 024>0, 034>3, 134>1}");
+  EXPECT_FALSE(g.find_isomorphism(h, p));
+  EXPECT_FALSE(h.find_isomorphism(g, p));
+  EXPECT_FALSE(g.is_isomorphic_slow(h));
+
+  // Agrees with is_isomorphic_slow() on all permutations of T3.
+  g = get_T3();
+  int q[5]{0, 1, 2, 3, 4};
+  do {
+    g.permute_for_testing(q, h);
+    EXPECT_TRUE(h.find_isomorphism(g, p));
+    h.permute_for_testing(p, f);
+    EXPECT_TRUE(f.is_identical(g));
+  } while (std::next_permutation(q, q + 5));
+}
+
+TEST(GraphTest, FindIsomorphismLarge) {
+  Graph::set_global_graph_info(2, 12);
+  // All vertices have the same degrees in all three graphs: g is a 12-cycle, h is g relabeled,
+  // and f is two 6-cycles. Bruteforce would need to try up to 12! permutations.
+  Graph g, h, f;
+  int r[12]{5, 3, 11, 0, 8, 1, 10, 2, 6, 9, 4, 7};
+  for (int v = 0; v < 12; v++) {
+    g.add_edge(Edge((1 << v) | (1 << (v + 1) % 12), UNDIRECTED));
+    h.add_edge(Edge((1 << r[v]) | (1 << r[(v + 1) % 12]), UNDIRECTED));
+    f.add_edge(Edge((1 << v) | (1 << (v / 6 * 6 + (v + 1) % 6)), UNDIRECTED));
+  }
+  int p[MAX_VERTICES];
+  EXPECT_TRUE(g.find_isomorphism(h, p));
+  Graph e;
+  g.permute_for_testing(p, e);
+  h.finalize_edges();
+  EXPECT_TRUE(e.is_identical(h));
+  EXPECT_FALSE(g.find_isomorphism(f, p));
+  EXPECT_FALSE(f.find_isomorphism(h, p));
+
+  // Canonical forms agree with the backtracking search.
+  g.canonicalize();
+  h.canonicalize();
+  f.canonicalize();
+  EXPECT_TRUE(g.is_isomorphic(h));
+  EXPECT_FALSE(g.is_isomorphic(f));
+}
+
+TEST(GraphTest, Automorphisms) {
+  // Verifies the automorphisms fixing the vertices >= n against all permutations of 0..n-1.
+  auto verify = [](Graph g, int n) {
+    g.finalize_edges();
+    std::vector<std::array<uint8, MAX_VERTICES>> automorphisms;
+    g.compute_automorphisms(n, 100000, automorphisms);
+    std::set<std::array<uint8, MAX_VERTICES>> found(automorphisms.begin(), automorphisms.end());
+    EXPECT_EQ(found.size(), automorphisms.size());
+
+    std::set<std::array<uint8, MAX_VERTICES>> expected;
+    int p[MAX_VERTICES];
+    std::iota(p, p + MAX_VERTICES, 0);
+    Graph h;
+    while (std::next_permutation(p, p + n)) {
+      g.permute_for_testing(p, h);
+      if (h.is_identical(g)) {
+        std::array<uint8, MAX_VERTICES> a;
+        std::copy(p, p + MAX_VERTICES, a.begin());
+        expected.insert(a);
+      }
+    }
+    EXPECT_EQ(found, expected);
+    return automorphisms.size();
+  };
+
+  Graph::set_global_graph_info(3, 5);
+  EXPECT_EQ(verify(Graph(), 5), 119);
+  EXPECT_EQ(verify(Graph(), 4), 23);
+  EXPECT_EQ(verify(get_T3(), 5), 0);
+  EXPECT_EQ(verify(parse_edges("{012}"), 4), 5);
+  EXPECT_EQ(verify(parse_edges("{012>2}"), 4), 1);
+
+  Graph::set_global_graph_info(3, 7);
+  // Vertices 4, 5 and 6 are isolated, but 5 and 6 are fixed, so only 1 and 2 can be swapped.
+  EXPECT_EQ(verify(parse_edges("{012, 013, 023, 123>3}"), 5), 1);
+  // Swaps 0 and 1.
+  EXPECT_EQ(verify(parse_edges("{012, 013>3, 245, 345>4}"), 6), 1);
+
+  // The count is limited by max_count.
+  Graph::set_global_graph_info(2, 12);
+  Graph g;
+  for (int v = 0; v < 12; v++) {
+    g.add_edge(Edge((1 << v) | (1 << (v + 1) % 12), UNDIRECTED));
+  }
+  std::vector<std::array<uint8, MAX_VERTICES>> automorphisms;
+  g.compute_automorphisms(12, 1000, automorphisms);
+  EXPECT_EQ(automorphisms.size(), 23);
+  g.compute_automorphisms(12, 10, automorphisms);
+  EXPECT_EQ(automorphisms.size(), 10);
+  Graph h;
+  for (const auto& a : automorphisms) {
+    int p[MAX_VERTICES];
+    std::copy(a.begin(), a.end(), p);
+    g.permute_for_testing(p, h);
+    EXPECT_TRUE(h.is_identical(g));
+  }
+}
+
 TEST(GraphTest, PermuteIsomorphic) {
   Graph g = get_T3();
   Graph h;
@@ -149,13 +372,16 @@ TEST(GraphTest, PermuteIsomorphic) {
 
 TEST(GraphTest, PermuteCanonical) {
   Graph g = get_T3();
-  g.canonicalize();
   Graph h;
   int p[5]{0, 1, 2, 3, 4};
-  g.permute_canonical(p, h);
-  EXPECT_TRUE(g.is_identical(h));
-  EXPECT_EQ(h.edge_count, 4);
-  EXPECT_EQ(h.undirected_edge_count, 2);
+  do {
+    // Any permutation of the graph has the same canonical form.
+    g.permute_for_testing(p, h);
+    h.canonicalize();
+    EXPECT_TRUE(g.is_identical(h));
+    EXPECT_EQ(h.edge_count, 4);
+    EXPECT_EQ(h.undirected_edge_count, 2);
+  } while (std::next_permutation(p, p + 5));
 }
 
 TEST(GraphTest, PermuteCanonical2) {
@@ -164,11 +390,16 @@ TEST(GraphTest, PermuteCanonical2) {
   Graph g = parse_edges("{03, 12, 02>2, 13>3}");
   g.canonicalize();
 
+  // Swapping two vertices with the same signature is not an automorphism here.
   int p[4]{0, 1, 3, 2};
-  g.permute_canonical(p, h);
-  EXPECT_TRUE(g.is_isomorphic(h));
-  h.permute_canonical(p, f);
+  g.permute_for_testing(p, h);
+  EXPECT_FALSE(g.is_identical(h));
+  h.permute_for_testing(p, f);
   EXPECT_TRUE(g.is_identical(f));
+
+  h.canonicalize();
+  EXPECT_TRUE(g.is_identical(h));
+  EXPECT_TRUE(g.is_isomorphic(h));
 }
 
 TEST(GraphTest, Canonicalize) {
@@ -252,6 +483,33 @@ TEST(GraphTest, Copy) {
   EXPECT_EQ(g.undirected_edge_count, h.undirected_edge_count);
 }
 
+TEST(GraphTest, Identical) {
+  Graph::set_global_graph_info(3, 5);
+  // Same edges added in different orders.
+  Graph g = parse_edges("{012, 013>1, 024>4, 134}");
+  Graph h;
+  h.add_edge(Edge(0b11010, UNDIRECTED));
+  h.add_edge(Edge(0b10101, 4));
+  h.add_edge(Edge(0b00111, UNDIRECTED));
+  h.add_edge(Edge(0b01011, 1));
+  EXPECT_TRUE(g.is_identical(h));
+  EXPECT_TRUE(h.is_identical(g));
+
+  // Differ in one head only, or in one edge only.
+  Graph f = parse_edges("{012, 013>1, 024>2, 134}");
+  EXPECT_FALSE(g.is_identical(f));
+  Graph e = parse_edges("{012, 013>1, 024>4, 234}");
+  EXPECT_FALSE(g.is_identical(e));
+  // A directed edge with head 0 vs an undirected edge.
+  Graph d = parse_edges("{012>0}");
+  Graph c = parse_edges("{012}");
+  EXPECT_FALSE(d.is_identical(c));
+  // Subset of the edges.
+  Graph b = parse_edges("{012, 013>1, 024>4}");
+  EXPECT_FALSE(g.is_identical(b));
+  EXPECT_FALSE(b.is_identical(g));
+}
+
 TEST(GraphTest, NonIsomorphic) {
   Graph g = get_T3();
 
@@ -273,10 +531,10 @@ TEST(GraphTest, NonIsomorphic) {
 
 TEST(GraphTest, NonIsomorphicWithSameHash) {
   Graph::set_global_graph_info(3, 5);
-  Graph g = parse_edges("{012>0, 013>1, 024, 134, 234}");
-  Graph h = parse_edges("{012>1, 013>0, 024, 134, 234}");
+  Graph g = parse_edges("{012, 014>1, 034>0, 234>3}");
+  Graph h = parse_edges("{012, 024>0, 034>3, 134>1}");
 
-  // The two graphs have the same hash, but not isomorphic
+  // The two graphs have the same hash (same degrees and codegree info), but not isomorphic
   g.canonicalize();
   h.canonicalize();
   EXPECT_FALSE(g.is_isomorphic(h));
@@ -291,7 +549,7 @@ TEST(GraphTest, IsomorphicWithSameHash) {
   g.canonicalize();
   h.canonicalize();
   EXPECT_EQ(g.get_graph_hash(), h.get_graph_hash());
-  EXPECT_FALSE(g.is_identical(h));
+  EXPECT_TRUE(g.is_identical(h));
   EXPECT_TRUE(h.is_isomorphic(g));
 }
 
@@ -299,15 +557,94 @@ TEST(GraphTest, IsomorphicNotIdentical) {
   Graph::set_global_graph_info(3, 5);
   Graph g = parse_edges("{013>3, 023, 123, 014, 024>4, 124}");
   Graph h = parse_edges("{013, 023>3, 123, 014>4, 024, 124}");
-  g.canonicalize();
-  h.canonicalize();
-
+  g.finalize_edges();
+  h.finalize_edges();
   EXPECT_FALSE(g.is_identical(h));
   EXPECT_FALSE(h.is_identical(g));
+
+  // The canonical forms of isomorphic graphs are identical.
+  g.canonicalize();
+  h.canonicalize();
+  EXPECT_TRUE(g.is_identical(h));
+  EXPECT_TRUE(h.is_identical(g));
   EXPECT_TRUE(g.is_isomorphic(h));
   EXPECT_TRUE(h.is_isomorphic(g));
 }
 
+TEST(GraphTest, CanonicalFormRegular) {
+  // All vertices have the same degrees, so the degrees alone can't tell the vertices apart.
+  Graph::set_global_graph_info(2, 6);
+  Graph g = parse_edges("{01>1, 12>2, 23>3, 34>4, 45>5, 05>0, 03, 14, 25}");
+  Graph h = parse_edges("{03>3, 23>2, 12>1, 15>5, 45>4, 04>0, 01, 35, 24}");
+  Graph f = parse_edges("{01>1, 12>2, 23>3, 34>4, 45>5, 05>0, 02, 14, 35}");
+  g.canonicalize();
+  h.canonicalize();
+  f.canonicalize();
+  EXPECT_TRUE(g.is_identical(h));
+  EXPECT_TRUE(g.is_isomorphic(h));
+  EXPECT_EQ(g.get_graph_hash(), f.get_graph_hash());
+  EXPECT_FALSE(g.is_identical(f));
+  EXPECT_FALSE(g.is_isomorphic(f));
+  EXPECT_FALSE(g.is_isomorphic_slow(f));
+
+  // Every permutation of the graph has the same canonical form.
+  int p[6]{0, 1, 2, 3, 4, 5};
+  do {
+    g.permute_for_testing(p, h);
+    h.canonicalize();
+    EXPECT_TRUE(g.is_identical(h));
+  } while (std::next_permutation(p, p + 6));
+}
+
+TEST(GraphTest, CodegreeSignature) {
+  // Both graphs are 2-regular, but the vertex pairs {0,1} and {4,5} are in two edges of h, and
+  // none of the vertex pairs is in two edges of g.
+  Graph::set_global_graph_info(3, 6);
+  Graph g = parse_edges("{012, 034, 135, 245}");
+  Graph h = parse_edges("{012, 013, 245, 345}");
+  uint64 g_codegrees[MAX_VERTICES];
+  uint64 h_codegrees[MAX_VERTICES];
+  uint64 g_hash = g.compute_codegree_signature(g_codegrees);
+  uint64 h_hash = h.compute_codegree_signature(h_codegrees);
+  EXPECT_NE(g_hash, h_hash);
+  for (int v = 1; v < 6; v++) {
+    EXPECT_EQ(g_codegrees[v], g_codegrees[0]);
+  }
+  // In h, vertices 0 and 1 are different from the other vertices.
+  EXPECT_EQ(h_codegrees[0], h_codegrees[1]);
+  EXPECT_EQ(h_codegrees[0], h_codegrees[4]);
+  EXPECT_EQ(h_codegrees[0], h_codegrees[5]);
+  EXPECT_NE(h_codegrees[0], h_codegrees[2]);
+  EXPECT_EQ(h_codegrees[2], h_codegrees[3]);
+
+  // The codegree info splits the vertices with the same degrees in h, but not in g.
+  uint64 codeg_diff = Counters::get_graph_isomorphic_codeg_diff();
+  g.canonicalize();
+  EXPECT_EQ(Counters::get_graph_isomorphic_codeg_diff(), codeg_diff);
+  h.canonicalize();
+  EXPECT_EQ(Counters::get_graph_isomorphic_codeg_diff(), codeg_diff + 1);
+  EXPECT_NE(g.get_graph_hash(), h.get_graph_hash());
+
+  // These two graphs have the same degrees, and used to have the same hash before the codegree
+  // info was added to the hash.
+  Graph f = parse_edges("{012>0, 013>1, 024, 134, 234}");
+  Graph e = parse_edges("{012>1, 013>0, 024, 134, 234}");
+  f.canonicalize();
+  e.canonicalize();
+  EXPECT_NE(f.get_graph_hash(), e.get_graph_hash());
+
+  // The codegree info is invariant under isomorphisms.
+  int p[6]{0, 1, 2, 3, 4, 5};
+  do {
+    h.permute_for_testing(p, f);
+    uint64 f_codegrees[MAX_VERTICES];
+    EXPECT_EQ(f.compute_codegree_signature(f_codegrees), h_hash);
+    f.canonicalize();
+    EXPECT_EQ(f.get_graph_hash(), h.get_graph_hash());
+    EXPECT_TRUE(f.is_identical(h));
+  } while (std::next_permutation(p, p + 6));
+}
+
 TEST(GraphTest, Isomorphic_B) {
   Graph::set_global_graph_info(2, 3);
   Graph g = parse_edges("{01>0, 02>2, 12>1}");
@@ -350,6 +687,38 @@ TEST(GraphTest, Theta) {
   EXPECT_EQ(l.get_theta_ratio(), Fraction(1, 1));
 }
 
+TEST(GraphTest, RatioTable) {
+  Graph::set_global_graph_info(3, 6);
+  const int total = Graph::TOTAL_EDGES;
+  // The ratio of (u, d), computed without the table.
+  auto theta = [total](int u, int d) {
+    return d == 0 ? Fraction::infinity() : Fraction(total - u, d);
+  };
+  auto zeta = [total](int u, int d) {
+    return u == 0 ? Fraction::infinity() : Fraction(total - d, u);
+  };
+  const Fraction values[]{Fraction(1, 1), Fraction(19, 10), Fraction(2, 1), Fraction(25, 1),
+                          Fraction::infinity()};
+  for (int u = 0; u <= total; u++) {
+    for (int d = 0; u + d <= total; d++) {
+      EXPECT_EQ(Graph::THETA_RATIOS.get_ratio(u, d), theta(u, d));
+      EXPECT_EQ(Graph::ZETA_RATIOS.get_ratio(u, d), zeta(u, d));
+      int rank = Graph::THETA_RATIOS.get_rank(u, d);
+      EXPECT_EQ(Graph::THETA_RATIOS.get_ratio_by_rank(rank), theta(u, d));
+      // The ranks compare the same way as the ratios.
+      for (int u2 = 0; u2 <= total; u2++) {
+        for (int d2 = 0; u2 + d2 <= total; d2++) {
+          EXPECT_EQ(rank < Graph::THETA_RATIOS.get_rank(u2, d2), theta(u, d) < theta(u2, d2));
+        }
+      }
+      for (const Fraction& x : values) {
+        EXPECT_EQ(rank >= Graph::THETA_RATIOS.count_less(x), theta(u, d) >= x);
+        EXPECT_EQ(rank < Graph::THETA_RATIOS.count_at_most(x), theta(u, d) <= x);
+      }
+    }
+  }
+}
+
 TEST(GraphTest, IsomorphicStress) {
   for (int diff = 0; diff <= 3; diff++) {
     for (int n = diff + 2; n <= 3; n++) {
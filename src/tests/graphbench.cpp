@@ -0,0 +1,233 @@
+// A micro benchmark of the Graph operations that are on the hot path of the growth phase.
+//
+// (1) Graph::finalize_edges(), which lists the edges in sorted order using the rank-indexed edge
+//     bitmap, against sorting the edge array with std::sort (the implementation before the edge
+//     bitmap was used for it).
+// (2) Graph::is_identical(), which compares the edge bitmap and the edge heads, against comparing
+//     the edge arrays one edge at a time (the implementation before), and Graph::is_isomorphic(),
+//     on the graphs of the growth levels.
+// (3) With arguments `candidate_order K N id...`, the final enumeration step of T_k-free graphs
+//     on the given base graphs (the ids as in kPDG), with each CandidateOrder. Prints the
+//     stats_tk_skip_bits, the edge sets generated and the wall time of each base graph.
+//
+#include "../counters.h"
+#include "../forbid_tk/graph_tk.h"
+
+constexpr int GRAPH_COUNT = 1000;
+constexpr int ROUNDS = 200;
+
+class GraphBenchmark {
+ public:
+  // Compares finalize_edges() against std::sort on random graphs, and prints the average time
+  // per graph in nanoseconds. Both include the time to copy the unsorted graph.
+  static void run_finalize_edges(int k, int n, std::mt19937& random_engine) {
+    Graph::set_global_graph_info(k, n);
+    // Random graphs with the edges added in random order.
+    std::vector<Graph> graphs(GRAPH_COUNT);
+    std::vector<int> ranks(Graph::TOTAL_EDGES);
+    std::iota(ranks.begin(), ranks.end(), 0);
+    std::uniform_int_distribution<> edge_count_random(1, Graph::TOTAL_EDGES);
+    std::uniform_int_distribution<> head_random(0, k);
+    uint64 total_edges = 0;
+    for (Graph& g : graphs) {
+      std::shuffle(ranks.begin(), ranks.end(), random_engine);
+      int edge_count = edge_count_random(random_engine);
+      for (int i = 0; i < edge_count; i++) {
+        uint16 vertex_set = Graph::VERTEX_MASKS[k].masks[ranks[i]];
+        // Use the j-th vertex in the set as the head, or undirected if j==k.
+        int j = head_random(random_engine);
+        uint16 bits = vertex_set;
+        for (int b = 0; b < j; b++) bits &= bits - 1;
+        g.add_edge(Edge(vertex_set, j == k ? UNDIRECTED : __builtin_ctz(bits)));
+      }
+      total_edges += edge_count;
+    }
+
+    Graph copy;
+    uint64 checksum_bitmap = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+      for (const Graph& g : graphs) {
+        copy = g;
+        copy.finalize_edges();
+        checksum_bitmap += copy.edges[copy.edge_count / 2].vertex_set;
+      }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    uint64 checksum_sort = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+      for (const Graph& g : graphs) {
+        copy = g;
+        std::sort(copy.edges, copy.edges + copy.edge_count,
+                  [](const Edge& a, const Edge& b) { return a.vertex_set < b.vertex_set; });
+        checksum_sort += copy.edges[copy.edge_count / 2].vertex_set;
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double calls = static_cast<double>(ROUNDS) * GRAPH_COUNT;
+    double bitmap_ns = std::chrono::duration<double, std::nano>(middle - start).count() / calls;
+    double sort_ns = std::chrono::duration<double, std::nano>(end - middle).count() / calls;
+    std::cout << "K=" << k << ", N=" << n << ", avg edges=" << total_edges / GRAPH_COUNT
+              << ":\tfinalize_edges " << bitmap_ns << " ns,\tstd::sort " << sort_ns << " ns"
+              << (checksum_bitmap == checksum_sort ? "" : "\tMISMATCH!") << "\n";
+  }
+
+  // Compares the edge arrays one edge at a time. The graphs must be canonicalized.
+  static bool is_identical_by_edges(const Graph& g, const Graph& h) {
+    if (g.edge_count != h.edge_count) return false;
+    for (int i = 0; i < g.edge_count; i++) {
+      if (g.edges[i].vertex_set != h.edges[i].vertex_set ||
+          g.edges[i].head_vertex != h.edges[i].head_vertex)
+        return false;
+    }
+    return true;
+  }
+
+  // Runs the given comparison function on all pairs, and prints the average time per call in
+  // nanoseconds, and the number of pairs where it returns true.
+  template <typename Compare>
+  static void time_pairs(const char* name, const std::vector<std::pair<Graph, Graph>>& pairs,
+                         Compare compare) {
+    constexpr int PAIR_ROUNDS = 20;
+    uint64 true_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < PAIR_ROUNDS; round++) {
+      for (const auto& p : pairs) {
+        true_count += compare(p.first, p.second) ? 1 : 0;
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double calls = static_cast<double>(PAIR_ROUNDS) * pairs.size();
+    std::cout << "    " << name << " "
+              << std::chrono::duration<double, std::nano>(end - start).count() / calls
+              << " ns,\ttrue=" << true_count / PAIR_ROUNDS << "\n";
+  }
+
+  // Grows the T_k-free graphs for (k, n) up to n-1 vertices, then benchmarks is_identical() and
+  // is_isomorphic() on the kinds of pairs compared by grow_step():
+  // isomorphic pairs (each graph vs a canonicalized copy, the common case), and non-isomorphic
+  // pairs with the same hash and edge counts (hash collisions).
+  static void run_is_identical(int k, int n) {
+    Graph::set_global_graph_info(k, n);
+    Counters::initialize();
+    GrowerTk grower(1, true, true, true, 0, 0);
+    GraphStore level;
+    Graph empty;
+    empty.canonicalize();
+    level.push_back(empty);
+    for (int m = k; m < n; m++) {
+      level = grower.grow_step(m, level);
+    }
+    // The last level also contains all the graphs from the previous levels.
+    std::vector<Graph> graphs;
+    for (size_t i = 0; i < level.size(); i++) {
+      graphs.push_back(level[i]);
+    }
+
+    std::vector<std::pair<Graph, Graph>> same_pairs;
+    std::map<std::tuple<uint32, uint8, uint8>, std::vector<int>> hash_groups;
+    for (size_t i = 0; i < graphs.size(); i++) {
+      Graph copy;
+      graphs[i].copy_edges(copy);
+      copy.canonicalize();
+      same_pairs.push_back(std::make_pair(graphs[i], copy));
+      hash_groups[std::make_tuple(graphs[i].get_graph_hash(), graphs[i].get_edge_count(),
+                                  graphs[i].get_undirected_edge_count())]
+          .push_back(i);
+    }
+    std::vector<std::pair<Graph, Graph>> collision_pairs;
+    for (const auto& [key, ids] : hash_groups) {
+      for (size_t i = 1; i < ids.size(); i++) {
+        collision_pairs.push_back(std::make_pair(graphs[ids[i - 1]], graphs[ids[i]]));
+      }
+    }
+
+    std::cout << "K=" << k << ", N=" << n << ", graphs=" << graphs.size()
+              << ", isomorphic pairs:\n";
+    time_pairs("is_identical         ", same_pairs,
+               [](const Graph& g, const Graph& h) { return g.is_identical(h); });
+    time_pairs("is_identical_by_edges", same_pairs, is_identical_by_edges);
+    time_pairs("is_isomorphic        ", same_pairs,
+               [](const Graph& g, const Graph& h) { return g.is_isomorphic(h); });
+    std::cout << "  same hash, non-isomorphic pairs=" << collision_pairs.size() << ":\n";
+    time_pairs("is_identical         ", collision_pairs,
+               [](const Graph& g, const Graph& h) { return g.is_identical(h); });
+    time_pairs("is_identical_by_edges", collision_pairs, is_identical_by_edges);
+    time_pairs("is_isomorphic        ", collision_pairs,
+               [](const Graph& g, const Graph& h) { return g.is_isomorphic(h); });
+  }
+
+  // Runs the final enumeration step of kPDG with the EdgeGenerator on the given base graphs, with
+  // each candidate order, and prints the stats and the time of each base graph, and the totals.
+  static void run_candidate_order(int k, int n, const std::vector<int>& ids) {
+    Graph::set_global_graph_info(k, n);
+    Counters::initialize();
+    GrowerTk grower(1, true, true, true, 0, 0);
+    GraphStore level;
+    Graph empty;
+    empty.canonicalize();
+    level.push_back(empty);
+    for (int m = k; m < n; m++) {
+      level = grower.grow_step(m, level);
+    }
+    std::cout << "K=" << k << ", N=" << n << ", base graphs=" << level.size() << "\n";
+
+    const std::pair<CandidateOrder, const char*> orders[] = {
+        {CandidateOrder::NATURAL, "natural    "},
+        {CandidateOrder::HIGH_DEGREE, "high_degree"},
+        {CandidateOrder::LOW_DEGREE, "low_degree "}};
+    for (const auto& [order, name] : orders) {
+      uint64 total_skip_bits = 0;
+      uint64 total_edge_sets = 0;
+      double total_ms = 0;
+      for (int id : ids) {
+        if (id < 0 || id >= static_cast<int>(level.size())) continue;
+        const Graph base = level[id];
+        auto start = std::chrono::steady_clock::now();
+        const EdgeCandidates edge_candidates(n, base, order);
+        EdgeGenerator edge_gen(edge_candidates, base);
+        Fraction min_ratio = Fraction::infinity();
+        Graph copy;
+        while (edge_gen.next(copy, true, min_ratio)) {
+          if (edge_gen.contains_Tk()) {
+            edge_gen.notify_contain_tk_skip();
+          } else {
+            edge_gen.notify_tk_free();
+            min_ratio = std::min(min_ratio, copy.get_theta_ratio());
+          }
+        }
+        auto end = std::chrono::steady_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << "  " << name << " G[" << id << "]: min_theta=" << min_ratio.to_string()
+                  << ",\ttk_skip_bits=" << edge_gen.stats_tk_skip_bits
+                  << ",\tedge_sets=" << edge_gen.stats_edge_sets << ",\t" << ms << " ms\n";
+        total_skip_bits += edge_gen.stats_tk_skip_bits;
+        total_edge_sets += edge_gen.stats_edge_sets;
+        total_ms += ms;
+      }
+      std::cout << "  " << name << " total: tk_skip_bits=" << total_skip_bits
+                << ",\tedge_sets=" << total_edge_sets << ",\t" << total_ms << " ms\n";
+    }
+  }
+};
+
+int main(int argc, char* argv[]) {
+  if (argc >= 4 && std::string(argv[1]) == "candidate_order") {
+    std::vector<int> ids;
+    for (int i = 4; i < argc; i++) {
+      ids.push_back(std::stoi(argv[i]));
+    }
+    GraphBenchmark::run_candidate_order(std::stoi(argv[2]), std::stoi(argv[3]), ids);
+    return 0;
+  }
+  std::mt19937 random_engine(12345);
+  for (int n = 7; n <= 8; n++) {
+    for (int k = 3; k <= 6; k++) {
+      GraphBenchmark::run_finalize_edges(k, n, random_engine);
+    }
+  }
+  GraphBenchmark::run_is_identical(3, 6);
+  GraphBenchmark::run_is_identical(4, 7);
+  return 0;
+}
@@ -15,6 +15,19 @@ void verify_array_equal(const std::vector<std::tuple<int, Graph, Graph>>& a,
   }
 }
 
+// Same as above, but only verifies the base graphs and the ratios of the min ratio graphs, for
+// the skeleton search and the other candidate orders, which may find a different graph with the
+// same ratio.
+void verify_ratios_equal(const std::vector<std::tuple<int, Graph, Graph>>& a,
+                         const std::vector<std::tuple<int, Graph, Graph>>& b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    ASSERT_EQ(std::get<0>(a[i]), std::get<0>(b[i]));
+    ASSERT_EQ(std::get<1>(a[i]).serialize_edges(), std::get<1>(b[i]).serialize_edges());
+    ASSERT_EQ(std::get<2>(a[i]).get_theta_ratio(), std::get<2>(b[i]).get_theta_ratio());
+  }
+}
+
 void verify_growth_result(int k, int n, Fraction min_theta, const std::string& min_theta_graph,
                           int num_threads) {
   Graph::set_global_graph_info(k, n);
@@ -49,12 +62,76 @@ void verify_growth_result(int k, int n, Fraction min_theta, const std::string& m
     EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
   }
 
+  Counters::initialize();
+  GrowerTk s5(num_threads, false, true, true, 0, 0);
+  s5.set_use_edge_searcher(true);
+  s5.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  // The symmetry breaking with both the edge generator and the edge searcher.
+  Counters::initialize();
+  GrowerTk s6(num_threads, false, true, true, 0, 0);
+  s6.set_use_symmetry_breaking(true);
+  s6.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  Counters::initialize();
+  GrowerTk s7(num_threads, false, true, true, 0, 0);
+  s7.set_use_edge_searcher(true);
+  s7.set_use_symmetry_breaking(true);
+  s7.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  Counters::initialize();
+  GrowerTk s8(num_threads, false, true, true, 0, 0);
+  s8.set_use_skeleton_search(true);
+  s8.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  // The target search with the edge searcher and with the skeleton searcher.
+  Counters::initialize();
+  GrowerTk s9(num_threads, false, true, true, 0, 0);
+  s9.set_use_target_search(true);
+  s9.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  Counters::initialize();
+  GrowerTk s10(num_threads, false, true, true, 0, 0);
+  s10.set_use_skeleton_search(true);
+  s10.set_use_target_search(true);
+  s10.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  // The other candidate orders, with the edge generator and with the edge searcher.
+  Counters::initialize();
+  GrowerTk s11(num_threads, false, true, true, 0, 0);
+  s11.set_candidate_order(CandidateOrder::HIGH_DEGREE);
+  s11.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
+  Counters::initialize();
+  GrowerTk s12(num_threads, false, true, true, 0, 0);
+  s12.set_candidate_order(CandidateOrder::LOW_DEGREE);
+  s12.set_use_edge_searcher(true);
+  s12.set_use_symmetry_breaking(true);
+  s12.grow();
+  EXPECT_TRUE(Counters::get_min_ratio() == min_theta);
+
   // In addition to the above, also verify that the resulting growth graphs are identical
-  // when different edge gen optimization combinations are used.
+  // when different edge gen optimization combinations (or the edge searcher, or the symmetry
+  // breaking) are used.
   if (num_threads == 0) {
     verify_array_equal(s1.get_results(), s2.get_results());
     verify_array_equal(s1.get_results(), s3.get_results());
     verify_array_equal(s1.get_results(), s4.get_results());
+    verify_array_equal(s1.get_results(), s5.get_results());
+    verify_array_equal(s1.get_results(), s6.get_results());
+    verify_array_equal(s1.get_results(), s7.get_results());
+    verify_ratios_equal(s1.get_results(), s8.get_results());
+    verify_ratios_equal(s1.get_results(), s9.get_results());
+    verify_ratios_equal(s1.get_results(), s10.get_results());
+    verify_ratios_equal(s1.get_results(), s11.get_results());
+    verify_ratios_equal(s1.get_results(), s12.get_results());
   }
 }
 
@@ -104,6 +181,48 @@ TEST(GrowerTest, GrowSlow) {
   //     " "012346789ab>0, 012356789ab>0, 012456789ab>0, 013456789ab>0, 023456789ab>0}", 9);
 }
 
+TEST(GrowerTest, GrowThreads) {
+  // The growth steps give the same base graphs (with the same ids) in the final step, and the
+  // final step gives the same results, with any number of threads.
+  for (const auto& [k, n] : std::vector<std::pair<int, int>>{{2, 6}, {3, 6}, {4, 6}}) {
+    Graph::set_global_graph_info(k, n);
+    Counters::initialize();
+    GrowerTk s0(0, false, true, true, 0, 0);
+    s0.set_use_skeleton_search(true);
+    s0.grow();
+    for (int num_threads : {1, 3, 8}) {
+      Counters::initialize();
+      GrowerTk s(num_threads, false, true, true, 0, 0);
+      s.set_use_skeleton_search(true);
+      s.grow();
+      verify_array_equal(s0.get_results(), s.get_results());
+    }
+  }
+}
+
+TEST(GrowerTest, SplitTasks) {
+  // The tasks of the base graphs in the final step are split for the idle threads, and the
+  // merged results have the same ratios with any number of threads.
+  uint64 split_tasks = 0;
+  for (const auto& [k, n] : std::vector<std::pair<int, int>>{{2, 7}, {3, 6}}) {
+    Graph::set_global_graph_info(k, n);
+    Counters::initialize();
+    GrowerTk s0(0, false, true, true, 0, 0);
+    s0.grow();
+    EXPECT_EQ(Counters::get_final_split_tasks(), 0);
+    const Fraction min_ratio = Counters::get_min_ratio();
+    for (int num_threads : {2, 8}) {
+      Counters::initialize();
+      GrowerTk s(num_threads, false, true, true, 0, 0);
+      s.grow();
+      verify_ratios_equal(s0.get_results(), s.get_results());
+      EXPECT_EQ(Counters::get_min_ratio(), min_ratio);
+      split_tasks += Counters::get_final_split_tasks();
+    }
+  }
+  EXPECT_GT(split_tasks, 0);
+}
+
 void verify_thetagraph_search(int k, int n, Fraction theta, int expected_thetagraph_count,
                               Fraction expected_min_theta) {
   Graph::set_global_graph_info(k, n);
@@ -153,6 +272,16 @@ TEST(GrowerTest, WithLogging) {
     s1.grow();
     EXPECT_EQ(Counters::get_min_ratio(), Fraction(3, 1));
   }
+  {
+    std::stringstream log, log_detail, log_result;
+    Counters::initialize();
+    GrowerTk s1(2, false, true, true, 0, 0, false, Fraction(1E8, 1));
+    s1.set_use_skeleton_search(true);
+    s1.set_logging(&log, &log_detail, &log_result);
+    s1.set_stats_print_interval(1, 0);
+    s1.grow();
+    EXPECT_EQ(Counters::get_min_ratio(), Fraction(3, 2));
+  }
 }
 
 TEST(GrowerTest, StartEndIndex) {
@@ -161,4 +290,21 @@ TEST(GrowerTest, StartEndIndex) {
   GrowerTk s(0, false, false, false, 0, 1);
   s.grow();
   EXPECT_EQ(Counters::get_min_ratio(), Fraction(3, 2));
+
+  // The threads claim the base graphs in chunks, and each base graph in the range gets exactly
+  // one result.
+  Graph::set_global_graph_info(3, 6);
+  Counters::initialize();
+  GrowerTk s0(0, false, true, true, 100, 200);
+  s0.grow();
+  ASSERT_EQ(s0.get_results().size(), 101);
+  for (int i = 0; i <= 100; i++) {
+    EXPECT_EQ(std::get<0>(s0.get_results()[i]), 100 + i);
+  }
+  for (int num_threads : {3, 8}) {
+    Counters::initialize();
+    GrowerTk s(num_threads, false, true, true, 100, 200);
+    s.grow();
+    verify_ratios_equal(s0.get_results(), s.get_results());
+  }
 }
\ No newline at end of file
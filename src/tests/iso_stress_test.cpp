@@ -8,6 +8,9 @@
 constexpr int FULL_TEST_THRESHOLD = 1000;
 constexpr int RANDOM_ITERATIONS = 10 * 1000 * 1000;
 constexpr uint8 NOT_IN_SET = 0xE;
+// Graph::is_isomorphic_slow() tries all N! permutations, so it is only used up to this N.
+// Larger graphs are verified against Graph::find_isomorphism() only.
+constexpr int MAX_SLOW_TEST_VERTICES = 7;
 
 IsomorphismStressTest::IsomorphismStressTest(int k_, int n_)
     : k(k_), n(n_), random_engine(std::random_device()()) {
@@ -67,6 +70,12 @@ bool IsomorphismStressTest::next_edge_state(uint8 edge_state[MAX_EDGES]) {
 
 void IsomorphismStressTest::verify_graphs(const Graph& g, const Graph& h) {
   bool iso_gh = g.is_isomorphic(h);
+  int p[MAX_VERTICES];
+  exit_assert(iso_gh, g.find_isomorphism(h, p), g, h, "iso!=backtrack");
+  exit_assert(iso_gh, h.find_isomorphism(g, p), h, g, "iso!=backtrack");
+  if (n > MAX_SLOW_TEST_VERTICES) {
+    return;
+  }
   bool iso_gh_slow = g.is_isomorphic_slow(h);
   bool iso_hg = h.is_isomorphic(g);
   bool iso_hg_slow = h.is_isomorphic_slow(g);
@@ -9,6 +9,9 @@
 // and we can easily verify its correctness by reviewing the code. So by using large number of
 // graphs to verify Graph::is_isomorphic()==Graph::is_isomorphic_slow(), we gain high confidence
 // that Graph::is_isomorphic() is implemented correctly.
+//
+// Graph::find_isomorphism() (backtracking search) is verified the same way. For N>7, where the
+// bruteforce is too slow, Graph::is_isomorphic() is only compared against it.
 
 #pragma once
 #include "../graph.h"
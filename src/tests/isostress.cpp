@@ -23,6 +23,11 @@ int main(int argc, char* argv[]) {
       t.run();
     }
   }
+  // Larger graphs, verified against the backtracking search.
+  for (int n = 8; n <= MAX_VERTICES; n++) {
+    IsomorphismStressTest t(2, n);
+    t.run();
+  }
   std::cout << "\nALL DONE\n";
   Counters::print_counters();
   return 0;